@@ -25,9 +25,16 @@
 #	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 #	THE SOFTWARE.
 #
+import os
 import time
-import usb.core
-import pyftdi.ftdi as ftdi
+import select
+
+
+class VMC96Error( RuntimeError ):
+
+	def __init__( self, message, code ):
+		RuntimeError.__init__( self, message )
+		self.code = code
 
 
 class VMC96( object ):
@@ -45,18 +52,29 @@ class VMC96( object ):
 	_MESSAGE_READ_MAX_RETRY             = 100
 
 	# Device Controllers
+	_CONTROLLER_GLOBAL                  = 0x00
 	_CONTROLLER_RELAY                   = 0x26
 	_CONTROLLER_MOTOR                   = 0x30
 
 	# Controller Commands
+	_COMMAND_SIMPLE_PING                = 0x00
+	_COMMAND_GLOBAL_RESET               = 0x01
+	_COMMAND_KERNEL_VERSION             = 0x02
 	_COMMAND_RELAY_CONTROL              = 0x11
 	_COMMAND_RELAY_RESET                = 0x05
 	_COMMAND_MOTOR_RUN                  = 0x13
 	_COMMAND_MOTOR_STOP_ALL             = 0x12
 	_COMMAND_MOTOR_RESET                = 0x05
+	_COMMAND_MOTOR_STATUS_REQUEST       = 0x10
+	_COMMAND_MOTOR_GIVE_PULSE           = 0x14
 	_COMMAND_MOTOR_OPTO_SENSOR_STATUS   = 0x15
 	_COMMAND_MOTOR_SCAN_ARRAY           = 0x11
 
+	# Motor Array Geometry
+	_MOTOR_ARRAY_ROWS                   = 8
+	_MOTOR_ARRAY_COLUMNS                = 12
+	_MOTOR_MAX_CURRENT_READING_MA       = 500
+
 	# Message Parser Results
 	_RESPONSE_VALID                     =  0
 	_ERR_RESPONSE_MALFORMED             = -1
@@ -64,22 +82,79 @@ class VMC96( object ):
 	_ERR_RESPONSE_INVALID_LENGTH        = -3
 	_ERR_RESPONSE_NEGATIVE_ACK          = -4
 	_ERR_RESPONSE_UNEXPECTED_CONTROLLER = -5
+	_ERR_RESPONSE_TIMEOUT               = -6
+
+	# Error Codes (VMC96Error.code, same values as the C library VMC96_ERROR_* codes)
+	ERROR_FTDI_INITIALIZE               = 101
+	ERROR_FTDI_OPEN_USB_DEVICE          = 103
+	ERROR_K1_RESPONSE_INVALID_CHECKSUM  = 201
+	ERROR_K1_RESPONSE_NEGATIVE_ACK      = 202
+	ERROR_K1_RESPONSE_MALFORMED         = 203
+	ERROR_K1_RESPONSE_INVALID_SOURCE    = 204
+	ERROR_K1_RESPONSE_INVALID_LENGTH    = 205
+	ERROR_K1_RESPONSE_TIMEOUT           = 206
+	ERROR_INVALID_MOTOR_COORDINATES     = 301
+	ERROR_TTY_OPEN_DEVICE               = 401
+
+	_ERROR_CODES = {
+		_ERR_RESPONSE_MALFORMED             : ERROR_K1_RESPONSE_MALFORMED,
+		_ERR_RESPONSE_INVALID_CHECKSUM      : ERROR_K1_RESPONSE_INVALID_CHECKSUM,
+		_ERR_RESPONSE_INVALID_LENGTH        : ERROR_K1_RESPONSE_INVALID_LENGTH,
+		_ERR_RESPONSE_NEGATIVE_ACK          : ERROR_K1_RESPONSE_NEGATIVE_ACK,
+		_ERR_RESPONSE_UNEXPECTED_CONTROLLER : ERROR_K1_RESPONSE_INVALID_SOURCE,
+		_ERR_RESPONSE_TIMEOUT               : ERROR_K1_RESPONSE_TIMEOUT,
+	}
 
 	# Log Callback Function
 	on_log = None
 
-	def __init__( self, invertedArray=False ):
+	def __init__( self, invertedArray=False, device=None ):
+		self.inverted = invertedArray
+		self.ftdi = None
+		self.fd = None
+		if( device != None ):
+			self._open_tty( device )
+		else:
+			self._open_ftdi()
+
+	def _open_ftdi( self ):
+		import usb.core
+		import pyftdi.ftdi as ftdi
 		try:
-			self.inverted = invertedArray
 			self.ftdi = ftdi.Ftdi()
 			self.ftdi.open( VMC96._FTDI_VENDOR_ID, VMC96._FTDI_PRODUCT_ID )
 			self.ftdi.set_baudrate( VMC96._FTDI_BAUD_RATE )
 			self.ftdi.set_line_property( 8, 1, 'N' )
 			self.ftdi.set_flowctrl('')
 		except usb.core.USBError as e:
-			raise RuntimeError("Error initializing VMC96 Device: " + str(e) )
+			raise VMC96Error( "Error initializing VMC96 Device: " + str(e), VMC96.ERROR_FTDI_OPEN_USB_DEVICE )
 		except:
-			raise RuntimeError("Error initializing VMC96 Device")
+			raise VMC96Error( "Error initializing VMC96 Device", VMC96.ERROR_FTDI_INITIALIZE )
+
+	def _open_tty( self, device ):
+		import termios
+		try:
+			self.fd = os.open( device, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK )
+			attrs = termios.tcgetattr( self.fd )
+			attrs[0] = 0                                                   # iflag: raw
+			attrs[1] = 0                                                   # oflag: raw
+			attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL        # cflag: 8N1, no flow control
+			attrs[3] = 0                                                   # lflag: raw
+			attrs[4] = termios.B19200
+			attrs[5] = termios.B19200
+			attrs[6][termios.VMIN] = 0
+			attrs[6][termios.VTIME] = 0
+			termios.tcsetattr( self.fd, termios.TCSANOW, attrs )
+		except OSError as e:
+			raise VMC96Error( "Error initializing VMC96 Device: " + str(e), VMC96.ERROR_TTY_OPEN_DEVICE )
+
+	def close( self ):
+		if( self.fd != None ):
+			os.close( self.fd )
+			self.fd = None
+		if( self.ftdi != None ):
+			self.ftdi.close()
+			self.ftdi = None
 
 	def __str__( self ):
 		return str("VMC96 API")
@@ -111,6 +186,8 @@ class VMC96( object ):
 			return "Negative Acknowledgement"
 		elif( err == VMC96._ERR_RESPONSE_UNEXPECTED_CONTROLLER ):
 			return "Unexpected Controller"
+		elif( err == VMC96._ERR_RESPONSE_TIMEOUT ):
+			return "Timeout"
 		else:
 			return "Unknown Error"
 
@@ -130,7 +207,23 @@ class VMC96( object ):
 		req.append( self._checksum( req ) )
 		return req
 
+	def _frame_complete( self, resp ):
+		if( len(resp) == 0 ):
+			return False
+		if( resp[0] != VMC96._MESSAGE_HEADER ):
+			return True
+		if( len(resp) < 3 ):
+			return False
+		if( resp[2] < VMC96._MESSAGE_MIN_LENGTH ):
+			return True
+		return len(resp) >= resp[2]
+
+	def _error( self, msg, err ):
+		return VMC96Error( msg + self._error_to_string(err), VMC96._ERROR_CODES[ err ] )
+
 	def _parse_response( self, cntrl, resp ):
+		if( not self._frame_complete( resp ) ):
+			return VMC96._ERR_RESPONSE_TIMEOUT, resp
 		if( len(resp) < VMC96._MESSAGE_MIN_LENGTH ):
 			return VMC96._ERR_RESPONSE_INVALID_LENGTH, resp
 		if( resp[0] != VMC96._MESSAGE_HEADER ):
@@ -146,27 +239,98 @@ class VMC96( object ):
 	def _invert_motor_id( self, mid ):
 		return ( ((mid & 0x0F) << 4) | ((mid & 0xF0) >> 4) )
 
+	def _write( self, req ):
+		if( self.fd != None ):
+			import termios
+			termios.tcflush( self.fd, termios.TCIOFLUSH )
+			os.write( self.fd, bytes(req) )
+		else:
+			self.ftdi.purge_buffers()
+			self.ftdi.write_data( bytes(req) )
+
+	def _read( self, size ):
+		if( self.fd != None ):
+			try:
+				return list( os.read( self.fd, size ) )
+			except BlockingIOError:
+				return []
+		return list( self.ftdi.read_data_bytes( size=size ) )
+
 	def _send_request( self, req ):
 		self._log( "VMC96 Request: " + self._request_to_string(req) )
-		self.ftdi.write_data( req )
+		self._write( req )
+		resp = []
 		for trial in range( 0, VMC96._MESSAGE_READ_MAX_RETRY  ):
-			time.sleep( VMC96._MESSAGE_RESPONSE_DELAY )
-			resp = self.ftdi.read_data_bytes( size=VMC96._MESSAGE_MAX_LENGTH )
-			if( len(resp) > 0 ):
+			if( self.fd != None ):
+				select.select( [ self.fd ], [], [], VMC96._MESSAGE_RESPONSE_DELAY )
+			else:
+				time.sleep( VMC96._MESSAGE_RESPONSE_DELAY )
+			resp += self._read( VMC96._MESSAGE_MAX_LENGTH - len(resp) )
+			if( self._frame_complete( resp ) ):
 				break
 		self._log( "VMC96 Response: " + self._response_to_string(resp) )
 		return resp
 
-	def _execute_command( self, cntrl, cmd, args=[] ):
+	def _execute_command( self, cntrl, cmd, args=[], ack=True ):
 		req = self._prepare_request( cntrl, cmd, args )
 		resp = self._send_request( req )
 		ret, data = self._parse_response( cntrl, resp )
+		if( ret == VMC96._RESPONSE_VALID and ack ):
+			if( len(data) != 1 ):
+				ret = VMC96._ERR_RESPONSE_INVALID_LENGTH
+			elif( data[0] != 0x00 ):
+				ret = VMC96._ERR_RESPONSE_NEGATIVE_ACK
 		if( ret != VMC96._RESPONSE_VALID ):
-			raise RuntimeError( "Invalid Response: " + self._error_to_string(ret) )
+			raise self._error( "Invalid Response: ", ret )
 		return data
 
+	def _motor_id( self, row, col ):
+		mid = ((row + 1) << 4) + (col + 1)
+		return mid if not self.inverted else self._invert_motor_id( mid )
+
+	def _check_motor_ids( self, ids ):
+		# Same coordinate validation as the C library: nothing is sent for invalid motors
+		for mid in ids:
+			if( not ( 1 <= (mid >> 4) <= VMC96._MOTOR_ARRAY_ROWS ) or not ( 1 <= (mid & 0x0F) <= VMC96._MOTOR_ARRAY_COLUMNS ) ):
+				raise VMC96Error( "Invalid Motor Coordinates: 0x{:02X}".format( mid ), VMC96.ERROR_INVALID_MOTOR_COORDINATES )
+		return [ mid if not self.inverted else self._invert_motor_id( mid ) for mid in ids ]
+
+	def _decode_version( self, data ):
+		return "".join( chr(c) for c in data[1:] )
+
+	def global_reset( self ):
+		return self._execute_command( VMC96._CONTROLLER_GLOBAL, VMC96._COMMAND_GLOBAL_RESET, [0xFF] )
+
+	def relay_ping( self, relay_id ):
+		return self._execute_command( VMC96._CONTROLLER_RELAY + relay_id, VMC96._COMMAND_SIMPLE_PING )
+
+	def relay_get_version( self, relay_id ):
+		return self._decode_version( self._execute_command( VMC96._CONTROLLER_RELAY + relay_id, VMC96._COMMAND_KERNEL_VERSION, ack=False ) )
+
+	def motor_ping( self ):
+		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_SIMPLE_PING )
+
+	def motor_get_version( self ):
+		return self._decode_version( self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_KERNEL_VERSION, ack=False ) )
+
+	def motor_pair_run( self, motor_id1, motor_id2 ):
+		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_RUN, self._check_motor_ids( [ motor_id1, motor_id2 ] ) )
+
+	def motor_give_pulse( self, motor_id, duration_ms ):
+		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_GIVE_PULSE, self._check_motor_ids( [ motor_id ] ) + [ duration_ms ] )
+
+	def motor_get_status( self ):
+		data = self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_STATUS_REQUEST, ack=False )
+		if( len(data) < 2 ):
+			return { "current_ma": 0, "active_count": 0, "running_motors": [] }
+		if( data[0] != VMC96._COMMAND_MOTOR_STATUS_REQUEST ):
+			raise self._error( "Invalid Motor Status Response: ", VMC96._ERR_RESPONSE_UNEXPECTED_CONTROLLER )
+		current_ma = ( VMC96._MOTOR_MAX_CURRENT_READING_MA * data[1] ) // 255
+		running = [ mid if not self.inverted else self._invert_motor_id( mid ) for mid in data[2:] ]
+		return { "current_ma": current_ma, "active_count": len(data) - 2, "running_motors": running }
+
 	def motor_run( self, motor_id ):
-		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_RUN, [ motor_id if not self.inverted else self._invert_motor_id( motor_id ) ] )
+		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_RUN, self._check_motor_ids( [ motor_id ] ) )
 
 	def motor_stop_all( self ):
 		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_STOP_ALL )
@@ -175,42 +339,36 @@ class VMC96( object ):
 		return self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_RESET )
 
 	def relay_reset( self, relay_id ):
-		return self._execute_command( VMC96._CONTROLLER_RELAY, VMC96.COMMAND_RELAY_RESET )
+		return self._execute_command( VMC96._CONTROLLER_RELAY + relay_id, VMC96._COMMAND_RELAY_RESET )
 
 	def relay_set_state( self, relay_id, state ):
 		return self._execute_command( VMC96._CONTROLLER_RELAY + relay_id, VMC96._COMMAND_RELAY_CONTROL, [state] )
 
 	def opto_sensor_read( self ):
 		ret = []
-		data = self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_OPTO_SENSOR_STATUS )
+		data = self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_OPTO_SENSOR_STATUS, ack=False )
 		if( len(data) != 5 ):
-			raise RuntimeError( "Invalid Opto Sensor Response: " + self._error_to_string(VMC96._ERR_RESPONSE_INVALID_LENGTH) )
+			raise self._error( "Invalid Opto Sensor Response: ", VMC96._ERR_RESPONSE_INVALID_LENGTH )
 		if( data[0] != VMC96._COMMAND_MOTOR_OPTO_SENSOR_STATUS ):
-			raise RuntimeError( "Invalid Opto Sensor Response: " + self._error_to_string(VMC96._ERR_RESPONSE_MALFORMED) )
+			raise self._error( "Invalid Opto Sensor Response: ", VMC96._ERR_RESPONSE_MALFORMED )
 		for byte in data[1:]:
 			for bit in range( 0, 8 ):
 				ret.append( (byte >> bit) & 0x01 )
 		return ret
 
 	def motor_scan_array( self ):
-		data = self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_SCAN_ARRAY )
-		if( len(data) < 2 ):
-			raise RuntimeError( "Invalid Motor Array Scan Response: " + self._error_to_string(VMC96._ERR_RESPONSE_INVALID_LENGTH) )
+		data = self._execute_command( VMC96._CONTROLLER_MOTOR, VMC96._COMMAND_MOTOR_SCAN_ARRAY, ack=False )
+		if( len(data) < 1 ):
+			raise self._error( "Invalid Motor Array Scan Response: ", VMC96._ERR_RESPONSE_INVALID_LENGTH )
 		if( data[0] != VMC96._COMMAND_MOTOR_SCAN_ARRAY ):
-			raise RuntimeError( "Invalid Motor Array Scan Response: " + self._error_to_string(VMC96._ERR_RESPONSE_MALFORMED) )
-		motor_array = []
-		for byte in data[1:]:
-			cols = []
-			for bit in range( 0, 8 ):
-				cols.append( (byte >> bit) & 0x01 )
-			motor_array.append(cols)
+			raise self._error( "Invalid Motor Array Scan Response: ", VMC96._ERR_RESPONSE_UNEXPECTED_CONTROLLER )
+		# One byte per column, one bit per row (columns missing from a short response are empty)
 		status = []
-		for idx_row, row in enumerate(motor_array):
-			for idx_col, col in enumerate(row):
-				if( motor_array[idx_row][idx_col] != 0 ):
-					status.append( "0x{X}{X}".format( idx_row + 1, idx_col + 1 ) )
-		current_ma = float(( 500.0 * int(data[1]) ) / 255.0)
-		return { "current_ma": current_ma, "available_motors": status }
+		for col, byte in enumerate( data[1:1 + VMC96._MOTOR_ARRAY_COLUMNS] ):
+			for row in range( 0, VMC96._MOTOR_ARRAY_ROWS ):
+				if( (byte >> row) & 0x01 ):
+					status.append( self._motor_id( row, col ) )
+		return { "count": len(status), "available_motors": sorted(status) }
 
 # end-of-file #
 
@@ -0,0 +1,711 @@
+/*!
+	\file vmc96bench.c
+	\brief K1 Protocol Encoder/Parser/Decoder Microbenchmark
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "vmc96k1.h"
+
+
+/* ********************************************************************* */
+/* *                              DEFINES                              * */
+/* ********************************************************************* */
+
+#define VMC96BENCH_DEFAULT_ITERATIONS                     (20000)
+#define VMC96BENCH_DEFAULT_TOLERANCE_PCT                  (25.0)
+#define VMC96BENCH_CORPUS_MAX_FRAMES                      (256)
+#define VMC96BENCH_METRIC_NAME_MAX_LEN                    (32)
+
+#define VMC96BENCH_SUCCESS                                (0)
+#define VMC96BENCH_ERROR_REGRESSION                       (1)
+#define VMC96BENCH_ERROR_CORPUS                           (2)
+#define VMC96BENCH_ERROR_ARGS                             (3)
+
+/* Corpus Frame Kinds */
+#define VMC96BENCH_FRAME_VALID                            (0)
+#define VMC96BENCH_FRAME_FRAGMENTED                       (1)
+#define VMC96BENCH_FRAME_CORRUPTED                        (2)
+
+/* Decoders */
+#define VMC96BENCH_DECODER_NONE                           (0)
+#define VMC96BENCH_DECODER_VERSION                        (1)
+#define VMC96BENCH_DECODER_MOTOR_STATUS                   (2)
+#define VMC96BENCH_DECODER_OPTO_LINE_STATUS               (3)
+#define VMC96BENCH_DECODER_SCAN_ARRAY                     (4)
+
+
+/* ********************************************************************* */
+/* *                        STRUCTS AND DATA TYPES                     * */
+/* ********************************************************************* */
+
+typedef struct vmc96bench_frame_s vmc96bench_frame_t;
+typedef struct vmc96bench_metric_s vmc96bench_metric_t;
+
+
+struct vmc96bench_frame_s
+{
+	int kind;
+	int decoder;
+	int expected;
+	vmc96_message_t request;
+	unsigned char k1[ VMC96_K1_MESSAGE_MAX_LEN ];
+	unsigned char k1_length;
+};
+
+
+struct vmc96bench_metric_s
+{
+	char name[ VMC96BENCH_METRIC_NAME_MAX_LEN ];
+	double ns_per_frame;
+};
+
+
+/* ********************************************************************* */
+/* *                              GLOBALS                              * */
+/* ********************************************************************* */
+
+static vmc96bench_frame_t g_corpus[ VMC96BENCH_CORPUS_MAX_FRAMES ];
+static int g_corpus_count = 0;
+
+/* Keeps the optimizer from discarding the measured work */
+static volatile unsigned long g_sink = 0;
+
+
+/* ********************************************************************* */
+/* *                               CORPUS                              * */
+/* ********************************************************************* */
+
+static double vmc96bench_now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+
+static vmc96bench_frame_t * vmc96bench_add_frame( int kind, int decoder, int expected, unsigned char cntlr, unsigned char cmd, const unsigned char * data, unsigned char datalen )
+{
+	vmc96bench_frame_t * frame = NULL;
+
+	if( g_corpus_count >= VMC96BENCH_CORPUS_MAX_FRAMES )
+	{
+		fprintf( stderr, "Corpus too large.\n" );
+		exit( VMC96BENCH_ERROR_CORPUS );
+	}
+
+	frame = &g_corpus[ g_corpus_count++ ];
+
+	memset( frame, 0, sizeof(vmc96bench_frame_t) );
+
+	frame->kind = kind;
+	frame->decoder = decoder;
+	frame->expected = expected;
+	frame->request.id_controller = cntlr;
+	frame->request.command = cmd;
+
+	if( datalen > 0 )
+		memcpy( frame->request.data, data, datalen );
+
+	frame->request.data_length = datalen;
+
+	vmc96_prepare_k1_message( &frame->request );
+
+	return frame;
+}
+
+
+static void vmc96bench_set_ack( vmc96bench_frame_t * frame, unsigned char ack )
+{
+	frame->k1[0] = VMC96_K1_MESSAGE_STX;
+	frame->k1[1] = frame->request.id_controller;
+	frame->k1[2] = VMC96_K1_MESSAGE_MIN_LEN;
+	frame->k1[3] = ack;
+	frame->k1[4] = vmc96_calculate_checksum( frame->k1, 4 );
+	frame->k1_length = VMC96_K1_MESSAGE_MIN_LEN;
+}
+
+
+static void vmc96bench_set_data( vmc96bench_frame_t * frame, const unsigned char * payload, unsigned char len )
+{
+	frame->k1[0] = VMC96_K1_MESSAGE_STX;
+	frame->k1[1] = frame->request.id_controller;
+	frame->k1[2] = len + 4;
+	memcpy( &frame->k1[3], payload, len );
+	frame->k1[ len + 3 ] = vmc96_calculate_checksum( frame->k1, len + 3 );
+	frame->k1_length = len + 4;
+}
+
+
+static vmc96bench_frame_t * vmc96bench_clone_frame( const vmc96bench_frame_t * valid, int kind, int decoder, int expected )
+{
+	vmc96bench_frame_t * frame = vmc96bench_add_frame( kind, decoder, expected, 0, 0, NULL, 0 );
+
+	memcpy( frame, valid, sizeof(vmc96bench_frame_t) );
+
+	frame->kind = kind;
+	frame->decoder = decoder;
+	frame->expected = expected;
+
+	return frame;
+}
+
+
+static void vmc96bench_add_variants( const vmc96bench_frame_t * valid )
+{
+	vmc96bench_frame_t * frame = NULL;
+
+	/* Same frame, delivered in small chunks */
+	vmc96bench_clone_frame( valid, VMC96BENCH_FRAME_FRAGMENTED, valid->decoder, valid->expected );
+
+	/* Invalid checksum */
+	frame = vmc96bench_clone_frame( valid, VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_NONE, VMC96_ERROR_K1_RESPONSE_INVALID_CHECKSUM );
+	frame->k1[ frame->k1_length - 1 ] ^= 0x5A;
+
+	/* Invalid STX header */
+	frame = vmc96bench_clone_frame( valid, VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_NONE, VMC96_ERROR_K1_RESPONSE_MALFORMED );
+	frame->k1[0] = 0x53;
+
+	/* Unexpected source controller */
+	frame = vmc96bench_clone_frame( valid, VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_NONE, VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE );
+	frame->k1[1] ^= 0x40;
+
+	/* Truncated (last byte lost) */
+	frame = vmc96bench_clone_frame( valid, VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_NONE, VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH );
+	frame->k1_length--;
+}
+
+
+static void vmc96bench_build_corpus( void )
+{
+	static const unsigned char version[] = { VMC96_COMMAND_KERNEL_VERSION, 'V', '1', '.', '0', '3' };
+	static const unsigned char status_idle[] = { VMC96_COMMAND_MOTOR_STATUS_REQUEST, 0x00 };
+	static const unsigned char status_one[] = { VMC96_COMMAND_MOTOR_STATUS_REQUEST, 0x40, 0x11 };
+	static const unsigned char status_pair[] = { VMC96_COMMAND_MOTOR_STATUS_REQUEST, 0x80, 0x35, 0x3C };
+	static const unsigned char status_bad_motor[] = { VMC96_COMMAND_MOTOR_STATUS_REQUEST, 0x80, 0x9D };
+	static const unsigned char opto[] = { VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS, 0x00, 0xF0, 0x0F, 0x81 };
+	static const unsigned char scan[] = { VMC96_COMMAND_MOTOR_SCAN_ARRAY, 0xFF, 0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01, 0x00, 0xAA, 0x55 };
+	static const unsigned char ack_cmds[] = { VMC96_COMMAND_SIMPLE_PING, VMC96_COMMAND_RESET, VMC96_COMMAND_MOTOR_STOP_ALL };
+	unsigned char arg[2] = { 0, 0 };
+	vmc96bench_frame_t * frame = NULL;
+	unsigned int i = 0;
+	unsigned char relay = 0;
+
+	/* Global Broadcast */
+	arg[0] = 0xFF;
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, VMC96_CONTROLLER_GLOBAL_BROADCAST, VMC96_COMMAND_GLOBAL_RESET, arg, 1 );
+	vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+	vmc96bench_add_variants( frame );
+
+	/* General Purpose Relays */
+	for( relay = VMC96_CONTROLLER_RELAY_1; relay <= VMC96_CONTROLLER_RELAY_2; relay++ )
+	{
+		frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, relay, VMC96_COMMAND_SIMPLE_PING, NULL, 0 );
+		vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+		vmc96bench_add_variants( frame );
+
+		frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, relay, VMC96_COMMAND_RESET, NULL, 0 );
+		vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+		vmc96bench_add_variants( frame );
+
+		arg[0] = 1;
+		frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, relay, VMC96_COMMAND_RELAY_FUNCTION, arg, 1 );
+		vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+		vmc96bench_add_variants( frame );
+
+		frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_VERSION, VMC96_SUCCESS, relay, VMC96_COMMAND_KERNEL_VERSION, NULL, 0 );
+		vmc96bench_set_data( frame, version, sizeof(version) );
+		vmc96bench_add_variants( frame );
+	}
+
+	/* Motor Array: ACK commands */
+	for( i = 0; i < sizeof(ack_cmds); i++ )
+	{
+		frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, ack_cmds[i], NULL, 0 );
+		vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+		vmc96bench_add_variants( frame );
+	}
+
+	arg[0] = VMC96_GET_MOTOR_ID( 3, 7 );
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_RUN, arg, 1 );
+	vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+	vmc96bench_add_variants( frame );
+
+	arg[1] = VMC96_GET_MOTOR_ID( 3, 8 );
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_RUN, arg, 2 );
+	vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+	vmc96bench_add_variants( frame );
+
+	arg[1] = 100;
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_NONE, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_GIVE_PULSE, arg, 2 );
+	vmc96bench_set_ack( frame, VMC96_K1_RESPONSE_POSITIVE_ACK );
+	vmc96bench_add_variants( frame );
+
+	/* Negative acknowledgement */
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_NONE, VMC96_ERROR_K1_RESPONSE_NEGATIVE_ACK, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_RUN, arg, 1 );
+	vmc96bench_set_ack( frame, 0x01 );
+
+	/* Motor Array: Data commands */
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_VERSION, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_KERNEL_VERSION, NULL, 0 );
+	vmc96bench_set_data( frame, version, sizeof(version) );
+	vmc96bench_add_variants( frame );
+
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_MOTOR_STATUS, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST, NULL, 0 );
+	vmc96bench_set_data( frame, status_idle, sizeof(status_idle) );
+	vmc96bench_add_variants( frame );
+
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_MOTOR_STATUS, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST, NULL, 0 );
+	vmc96bench_set_data( frame, status_one, sizeof(status_one) );
+	vmc96bench_add_variants( frame );
+
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_MOTOR_STATUS, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST, NULL, 0 );
+	vmc96bench_set_data( frame, status_pair, sizeof(status_pair) );
+	vmc96bench_add_variants( frame );
+
+	/* Well formed frame carrying an out of range motor id */
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_MOTOR_STATUS, VMC96_ERROR_K1_RESPONSE_MALFORMED, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST, NULL, 0 );
+	vmc96bench_set_data( frame, status_bad_motor, sizeof(status_bad_motor) );
+
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_OPTO_LINE_STATUS, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS, NULL, 0 );
+	vmc96bench_set_data( frame, opto, sizeof(opto) );
+	vmc96bench_add_variants( frame );
+
+	/* Well formed frame with a short opto sample block */
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_CORRUPTED, VMC96BENCH_DECODER_OPTO_LINE_STATUS, VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS, NULL, 0 );
+	vmc96bench_set_data( frame, opto, 3 );
+
+	frame = vmc96bench_add_frame( VMC96BENCH_FRAME_VALID, VMC96BENCH_DECODER_SCAN_ARRAY, VMC96_SUCCESS, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_SCAN_ARRAY, NULL, 0 );
+	vmc96bench_set_data( frame, scan, sizeof(scan) );
+	vmc96bench_add_variants( frame );
+}
+
+
+/* ********************************************************************* */
+/* *                            EXECUTION                              * */
+/* ********************************************************************* */
+
+static int vmc96bench_decode( const vmc96bench_frame_t * frame, const vmc96_message_t * response )
+{
+	char version[ VMC96_VERSION_STRING_MAX_LEN + 1 ];
+	VMC96_motor_array_status_t status;
+	VMC96_opto_line_sample_block_t block;
+	VMC96_motor_array_scan_result_t scan;
+	int ret = VMC96_SUCCESS;
+
+	switch( frame->decoder )
+	{
+		case VMC96BENCH_DECODER_VERSION:
+			ret = vmc96_k1_decode_version( response, version );
+			g_sink += version[0];
+			break;
+
+		case VMC96BENCH_DECODER_MOTOR_STATUS:
+			memset( &status, 0, sizeof(status) );
+			ret = vmc96_k1_decode_motor_status( response, &status );
+			g_sink += status.active_count;
+			break;
+
+		case VMC96BENCH_DECODER_OPTO_LINE_STATUS:
+			ret = vmc96_k1_decode_opto_line_status( response, &block );
+			g_sink += block.sample[0];
+			break;
+
+		case VMC96BENCH_DECODER_SCAN_ARRAY:
+			memset( &scan, 0, sizeof(scan) );
+			ret = vmc96_k1_decode_scan_array( response, &scan );
+			g_sink += scan.count;
+			break;
+
+		default:
+			break;
+	}
+
+	return ret;
+}
+
+
+static int vmc96bench_receive( const vmc96bench_frame_t * frame, vmc96_message_t * response )
+{
+	size_t chunk = 0;
+	size_t i = 0;
+
+	response->k1_length = 0;
+
+	if( frame->kind != VMC96BENCH_FRAME_FRAGMENTED )
+	{
+		memcpy( response->k1, frame->k1, frame->k1_length );
+		response->k1_length = frame->k1_length;
+		return vmc96_k1_frame_complete( response->k1, response->k1_length );
+	}
+
+	/* Deliver 1, 2, 3, 1, 2, 3... bytes at a time, as slow USB reads do */
+	for( i = 0; i < frame->k1_length; i += chunk )
+	{
+		chunk = ( i % 3 ) + 1;
+
+		if( i + chunk > frame->k1_length )
+			chunk = frame->k1_length - i;
+
+		memcpy( response->k1 + i, frame->k1 + i, chunk );
+		response->k1_length += chunk;
+
+		if( vmc96_k1_frame_complete( response->k1, response->k1_length ) )
+			return 1;
+	}
+
+	return 0;
+}
+
+
+static int vmc96bench_process( const vmc96bench_frame_t * frame, vmc96_message_t * response )
+{
+	int ret = 0;
+
+	if( !vmc96bench_receive( frame, response ) && (frame->kind != VMC96BENCH_FRAME_CORRUPTED) )
+		return VMC96_ERROR_K1_RESPONSE_TIMEOUT;
+
+	ret = vmc96_parse_k1_response( &frame->request, response );
+
+	if( ret != VMC96_SUCCESS )
+		return ret;
+
+	return vmc96bench_decode( frame, response );
+}
+
+
+static int vmc96bench_check_corpus( void )
+{
+	vmc96_message_t response;
+	int errors = 0;
+	int ret = 0;
+	int i = 0;
+
+	for( i = 0; i < g_corpus_count; i++ )
+	{
+		ret = vmc96bench_process( &g_corpus[i], &response );
+
+		if( ret != g_corpus[i].expected )
+		{
+			fprintf( stderr, "Corpus frame #%d (cntlr=0x%02X cmd=0x%02X kind=%d): expected %d, got %d\n",
+				i, g_corpus[i].request.id_controller, g_corpus[i].request.command, g_corpus[i].kind,
+				g_corpus[i].expected, ret );
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+
+static double vmc96bench_run_encode( int iterations )
+{
+	vmc96_message_t message;
+	double start = 0;
+	int frames = 0;
+	int n = 0;
+	int i = 0;
+
+	start = vmc96bench_now_ns();
+
+	for( n = 0; n < iterations; n++ )
+	{
+		for( i = 0; i < g_corpus_count; i++ )
+		{
+			if( g_corpus[i].kind != VMC96BENCH_FRAME_VALID )
+				continue;
+
+			message.id_controller = g_corpus[i].request.id_controller;
+			message.command = g_corpus[i].request.command;
+			message.data_length = g_corpus[i].request.data_length;
+			memcpy( message.data, g_corpus[i].request.data, message.data_length );
+
+			vmc96_prepare_k1_message( &message );
+
+			g_sink += message.k1[ message.k1_length - 1 ];
+			frames++;
+		}
+	}
+
+	return ( vmc96bench_now_ns() - start ) / frames;
+}
+
+
+static double vmc96bench_run_checksum( int iterations )
+{
+	unsigned char buf[ VMC96_K1_MESSAGE_MAX_LEN ];
+	double start = 0;
+	int n = 0;
+
+	for( n = 0; n < VMC96_K1_MESSAGE_MAX_LEN; n++ )
+		buf[n] = (unsigned char) ( n * 7 );
+
+	start = vmc96bench_now_ns();
+
+	for( n = 0; n < iterations * 16; n++ )
+	{
+		buf[0] = (unsigned char) n;
+		g_sink += vmc96_calculate_checksum( buf, sizeof(buf) );
+	}
+
+	return ( vmc96bench_now_ns() - start ) / ( iterations * 16 );
+}
+
+
+static double vmc96bench_run_validate( int iterations, int kind )
+{
+	vmc96_message_t response;
+	double start = 0;
+	int frames = 0;
+	int n = 0;
+	int i = 0;
+
+	start = vmc96bench_now_ns();
+
+	for( n = 0; n < iterations; n++ )
+	{
+		for( i = 0; i < g_corpus_count; i++ )
+		{
+			if( g_corpus[i].kind != kind )
+				continue;
+
+			vmc96bench_receive( &g_corpus[i], &response );
+
+			g_sink += vmc96_parse_k1_response( &g_corpus[i].request, &response );
+			frames++;
+		}
+	}
+
+	return ( vmc96bench_now_ns() - start ) / frames;
+}
+
+
+static double vmc96bench_run_decode( int iterations, int decoder )
+{
+	vmc96_message_t responses[ VMC96BENCH_CORPUS_MAX_FRAMES ];
+	const vmc96bench_frame_t * frames[ VMC96BENCH_CORPUS_MAX_FRAMES ];
+	double start = 0;
+	int count = 0;
+	int n = 0;
+	int i = 0;
+
+	/* Decoders run on already parsed responses */
+	for( i = 0; i < g_corpus_count; i++ )
+	{
+		if( (g_corpus[i].kind != VMC96BENCH_FRAME_VALID) || (g_corpus[i].decoder != decoder) )
+			continue;
+
+		vmc96bench_receive( &g_corpus[i], &responses[ count ] );
+		vmc96_parse_k1_response( &g_corpus[i].request, &responses[ count ] );
+		frames[ count++ ] = &g_corpus[i];
+	}
+
+	if( count == 0 )
+		return 0;
+
+	start = vmc96bench_now_ns();
+
+	for( n = 0; n < iterations; n++ )
+		for( i = 0; i < count; i++ )
+			vmc96bench_decode( frames[i], &responses[i] );
+
+	return ( vmc96bench_now_ns() - start ) / ( (double) iterations * count );
+}
+
+
+/* ********************************************************************* */
+/* *                          REGRESSION GATE                          * */
+/* ********************************************************************* */
+
+static int vmc96bench_save( const char * path, const vmc96bench_metric_t * metrics, int count )
+{
+	FILE * fp = NULL;
+	int i = 0;
+
+	fp = fopen( path, "w" );
+
+	if( !fp )
+	{
+		fprintf( stderr, "Can not write baseline file: %s\n", path );
+		return VMC96BENCH_ERROR_ARGS;
+	}
+
+	for( i = 0; i < count; i++ )
+		fprintf( fp, "%s %.2f\n", metrics[i].name, metrics[i].ns_per_frame );
+
+	fclose( fp );
+
+	return VMC96BENCH_SUCCESS;
+}
+
+
+static int vmc96bench_compare( const char * path, const vmc96bench_metric_t * metrics, int count, double tolerance )
+{
+	char name[ VMC96BENCH_METRIC_NAME_MAX_LEN ];
+	double baseline = 0;
+	double limit = 0;
+	FILE * fp = NULL;
+	int ret = VMC96BENCH_SUCCESS;
+	int i = 0;
+
+	fp = fopen( path, "r" );
+
+	if( !fp )
+	{
+		fprintf( stderr, "Can not read baseline file: %s\n", path );
+		return VMC96BENCH_ERROR_ARGS;
+	}
+
+	while( fscanf( fp, "%31s %lf", name, &baseline ) == 2 )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			if( strcmp( name, metrics[i].name ) != 0 )
+				continue;
+
+			limit = baseline * ( 1.0 + tolerance / 100.0 );
+
+			if( metrics[i].ns_per_frame > limit )
+			{
+				fprintf( stderr, "REGRESSION: %s %.2f ns/frame (baseline %.2f, limit %.2f)\n", name, metrics[i].ns_per_frame, baseline, limit );
+				ret = VMC96BENCH_ERROR_REGRESSION;
+			}
+		}
+	}
+
+	fclose( fp );
+
+	return ret;
+}
+
+
+/* ********************************************************************* */
+/* *                                MAIN                               * */
+/* ********************************************************************* */
+
+static void vmc96bench_show_usage( void )
+{
+	printf( "vmc96bench [--iterations=N] [--save=FILE] [--baseline=FILE] [--tolerance=PERCENT]\n\n" );
+	printf( "	--iterations   Passes over the frame corpus per metric (default: %d).\n", VMC96BENCH_DEFAULT_ITERATIONS );
+	printf( "	--save         Write the measured metrics as a baseline file.\n" );
+	printf( "	--baseline     Fail (exit code %d) if any metric is slower than the baseline file allows.\n", VMC96BENCH_ERROR_REGRESSION );
+	printf( "	--tolerance    Allowed slowdown over the baseline in percent (default: %.0f).\n\n", VMC96BENCH_DEFAULT_TOLERANCE_PCT );
+}
+
+
+int main( int argc, char ** argv )
+{
+	int ret = 0;
+	int index = 0;
+	int iterations = VMC96BENCH_DEFAULT_ITERATIONS;
+	double tolerance = VMC96BENCH_DEFAULT_TOLERANCE_PCT;
+	const char * save = NULL;
+	const char * baseline = NULL;
+	vmc96bench_metric_t metrics[] =
+	{
+		{ "encode",               0 },
+		{ "checksum_255",         0 },
+		{ "validate_valid",       0 },
+		{ "validate_fragmented",  0 },
+		{ "validate_corrupted",   0 },
+		{ "decode_version",       0 },
+		{ "decode_motor_status",  0 },
+		{ "decode_opto_line",     0 },
+		{ "decode_scan_array",    0 }
+	};
+	int count = sizeof(metrics) / sizeof(metrics[0]);
+	int i = 0;
+
+	static struct option options[] =
+	{
+		{ "iterations",  required_argument, 0,  'a' },
+		{ "save",        required_argument, 0,  'b' },
+		{ "baseline",    required_argument, 0,  'c' },
+		{ "tolerance",   required_argument, 0,  'd' },
+		{ "help",        no_argument,       0,  'e' },
+		{ NULL,          no_argument,       0,   0  }
+	};
+
+	while( (ret = getopt_long( argc, argv, "a:b:c:d:e", options, &index )) != -1 )
+	{
+		switch( ret )
+		{
+			case 'a' : iterations = atoi( optarg ); break;
+			case 'b' : save = optarg; break;
+			case 'c' : baseline = optarg; break;
+			case 'd' : tolerance = atof( optarg ); break;
+
+			default :
+				vmc96bench_show_usage();
+				return VMC96BENCH_ERROR_ARGS;
+		}
+	}
+
+	if( iterations <= 0 )
+	{
+		vmc96bench_show_usage();
+		return VMC96BENCH_ERROR_ARGS;
+	}
+
+	vmc96bench_build_corpus();
+
+	if( vmc96bench_check_corpus() != 0 )
+		return VMC96BENCH_ERROR_CORPUS;
+
+	metrics[0].ns_per_frame = vmc96bench_run_encode( iterations );
+	metrics[1].ns_per_frame = vmc96bench_run_checksum( iterations );
+	metrics[2].ns_per_frame = vmc96bench_run_validate( iterations, VMC96BENCH_FRAME_VALID );
+	metrics[3].ns_per_frame = vmc96bench_run_validate( iterations, VMC96BENCH_FRAME_FRAGMENTED );
+	metrics[4].ns_per_frame = vmc96bench_run_validate( iterations, VMC96BENCH_FRAME_CORRUPTED );
+	metrics[5].ns_per_frame = vmc96bench_run_decode( iterations, VMC96BENCH_DECODER_VERSION );
+	metrics[6].ns_per_frame = vmc96bench_run_decode( iterations, VMC96BENCH_DECODER_MOTOR_STATUS );
+	metrics[7].ns_per_frame = vmc96bench_run_decode( iterations, VMC96BENCH_DECODER_OPTO_LINE_STATUS );
+	metrics[8].ns_per_frame = vmc96bench_run_decode( iterations, VMC96BENCH_DECODER_SCAN_ARRAY );
+
+	fprintf( stdout, "K1 CODEC MICROBENCHMARK (%d corpus frames, %d iterations):\n\n", g_corpus_count, iterations );
+
+	for( i = 0; i < count; i++ )
+		fprintf( stdout, "	%-22s %10.2f ns/frame\n", metrics[i].name, metrics[i].ns_per_frame );
+
+	fprintf( stdout, "\n" );
+
+	ret = VMC96BENCH_SUCCESS;
+
+	if( save )
+		ret = vmc96bench_save( save, metrics, count );
+
+	if( (ret == VMC96BENCH_SUCCESS) && baseline )
+		ret = vmc96bench_compare( baseline, metrics, count, tolerance );
+
+	return ret;
+}
+
+/* eof */
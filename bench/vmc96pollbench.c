@@ -0,0 +1,547 @@
+/*!
+	\file vmc96pollbench.c
+	\brief Single-Thread poll() vs io_uring Transport Benchmark over many TTY Boards
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sys/resource.h>
+
+#include "vmc96api.h"
+#include "vmc96uring.h"
+
+
+/* ********************************************************************* */
+/* *                              DEFINES                              * */
+/* ********************************************************************* */
+
+#define VMC96POLLBENCH_DEFAULT_TRANSACTIONS               (2000)
+#define VMC96POLLBENCH_MAX_BOARDS                         (64)
+#define VMC96POLLBENCH_POLL_TIMEOUT_MS                    (100)
+
+#define VMC96POLLBENCH_TRANSPORT_POLL                     (1)
+#define VMC96POLLBENCH_TRANSPORT_URING                    (2)
+#define VMC96POLLBENCH_TRANSPORT_BOTH                     (VMC96POLLBENCH_TRANSPORT_POLL | VMC96POLLBENCH_TRANSPORT_URING)
+
+#define VMC96POLLBENCH_SUCCESS                            (0)
+#define VMC96POLLBENCH_ERROR_TRANSACTION                  (1)
+#define VMC96POLLBENCH_ERROR_URING                        (2)
+#define VMC96POLLBENCH_ERROR_ARGS                         (3)
+
+
+/* ********************************************************************* */
+/* *                        STRUCTS AND DATA TYPES                     * */
+/* ********************************************************************* */
+
+typedef struct vmc96pollbench_board_s vmc96pollbench_board_t;
+typedef struct vmc96pollbench_counters_s vmc96pollbench_counters_t;
+typedef struct vmc96pollbench_result_s vmc96pollbench_result_t;
+
+
+struct vmc96pollbench_board_s
+{
+	VMC96_t * vmc96;
+	const char * device;
+	VMC96_motor_array_status_t status;
+	double started_ns;
+	int remaining;
+};
+
+
+struct vmc96pollbench_counters_s
+{
+	int valid;
+	unsigned long syscr;
+	unsigned long syscw;
+	unsigned long csw;
+	double cpu_ns;
+	double wall_ns;
+};
+
+
+struct vmc96pollbench_result_s
+{
+	const char * name;
+	unsigned long completed;
+	unsigned long waits;
+	unsigned long flushes;
+	double latency_sum_ns;
+	double latency_max_ns;
+	vmc96pollbench_counters_t before;
+	vmc96pollbench_counters_t after;
+};
+
+
+/* ********************************************************************* */
+/* *                          IMPLEMENTATION                           * */
+/* ********************************************************************* */
+
+
+static double vmc96pollbench_now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+
+static void vmc96pollbench_read_counters( vmc96pollbench_counters_t * counters )
+{
+	char line[ 64 ];
+	struct rusage ru;
+	FILE * fp = NULL;
+
+	memset( counters, 0, sizeof(vmc96pollbench_counters_t) );
+
+	getrusage( RUSAGE_SELF, &ru );
+
+	counters->cpu_ns = ( (double) ru.ru_utime.tv_sec + (double) ru.ru_stime.tv_sec ) * 1e9 +
+	                   ( (double) ru.ru_utime.tv_usec + (double) ru.ru_stime.tv_usec ) * 1e3;
+
+	counters->csw = ru.ru_nvcsw + ru.ru_nivcsw;
+
+	/* read()/write() syscall counters kept by the kernel */
+	fp = fopen( "/proc/self/io", "r" );
+
+	if( fp )
+	{
+		while( fgets( line, sizeof(line), fp ) )
+		{
+			sscanf( line, "syscr: %lu", &counters->syscr );
+			sscanf( line, "syscw: %lu", &counters->syscw );
+		}
+
+		fclose( fp );
+		counters->valid = 1;
+	}
+
+	counters->wall_ns = vmc96pollbench_now_ns();
+}
+
+
+static int vmc96pollbench_start( vmc96pollbench_board_t * board )
+{
+	int ret = 0;
+
+	board->started_ns = vmc96pollbench_now_ns();
+
+	ret = vmc96_motor_get_status( board->vmc96, &board->status );
+
+	return ( ret == VMC96_ERROR_K1_RESPONSE_PENDING ) ? VMC96_SUCCESS : ret;
+}
+
+
+/* Accounts a finished transaction and sends the next one; returns 1 when the board is done */
+static int vmc96pollbench_finish( vmc96pollbench_result_t * result, vmc96pollbench_board_t * board, int * ret )
+{
+	double latency_ns = vmc96pollbench_now_ns() - board->started_ns;
+
+	result->latency_sum_ns += latency_ns;
+
+	if( latency_ns > result->latency_max_ns )
+		result->latency_max_ns = latency_ns;
+
+	result->completed++;
+
+	if( --board->remaining == 0 )
+		return 1;
+
+	*ret = vmc96pollbench_start( board );
+
+	return 0;
+}
+
+
+static int vmc96pollbench_run_poll( vmc96pollbench_board_t * board, int count, int transactions, vmc96pollbench_result_t * result )
+{
+	struct pollfd pfd[ VMC96POLLBENCH_MAX_BOARDS ];
+	int active = 0;
+	int ready = 0;
+	int ret = 0;
+	int i = 0;
+
+	result->name = "poll()";
+
+	for( i = 0; i < count; i++ )
+	{
+		vmc96_set_nonblocking( board[i].vmc96, 1 );
+
+		pfd[i].fd = vmc96_get_fd( board[i].vmc96 );
+		board[i].remaining = transactions;
+	}
+
+	vmc96pollbench_read_counters( &result->before );
+
+	for( i = 0; i < count; i++ )
+	{
+		ret = vmc96pollbench_start( &board[i] );
+
+		if( ret != VMC96_SUCCESS )
+			goto transaction_error;
+	}
+
+	active = count;
+
+	while( active > 0 )
+	{
+		for( i = 0; i < count; i++ )
+			pfd[i].events = ( vmc96_write_pending( board[i].vmc96 ) ) ? (POLLIN | POLLOUT) : POLLIN;
+
+		ready = poll( pfd, count, VMC96POLLBENCH_POLL_TIMEOUT_MS );
+		result->waits++;
+
+		for( i = 0; i < count; i++ )
+		{
+			/* Nothing ready: let every board check its response deadline */
+			if( (board[i].remaining == 0) || ((ready > 0) && !pfd[i].revents) )
+				continue;
+
+			ret = vmc96_poll( board[i].vmc96 );
+
+			if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+				continue;
+
+			if( ret != VMC96_SUCCESS )
+				goto transaction_error;
+
+			if( vmc96pollbench_finish( result, &board[i], &ret ) )
+			{
+				/* Stop watching this board */
+				pfd[i].fd = -1;
+				active--;
+				continue;
+			}
+
+			if( ret != VMC96_SUCCESS )
+				goto transaction_error;
+		}
+	}
+
+	vmc96pollbench_read_counters( &result->after );
+
+	/* Every request starts with tcflush() */
+	result->flushes = result->completed;
+
+	return VMC96POLLBENCH_SUCCESS;
+
+transaction_error:
+
+	fprintf( stderr, "poll(): %s: Error: %s (Cod: %d)\n", board[i].device, vmc96_get_error_code_string(ret), ret );
+
+	return VMC96POLLBENCH_ERROR_TRANSACTION;
+}
+
+
+static int vmc96pollbench_run_uring( vmc96pollbench_board_t * board, int count, int transactions, vmc96pollbench_result_t * result )
+{
+	VMC96_uring_completion_t completion[ VMC96POLLBENCH_MAX_BOARDS ];
+	VMC96_uring_t * ring = NULL;
+	unsigned long enter_count = 0;
+	int completed = 0;
+	int attached = 0;
+	int active = 0;
+	int ret = 0;
+	int i = 0;
+	int j = 0;
+
+	result->name = "io_uring";
+
+	ret = vmc96_uring_create( &ring );
+
+	if( ret != VMC96_SUCCESS )
+	{
+		fprintf( stderr, "io_uring: Error: %s (Cod: %d)\n", vmc96_get_error_code_string(ret), ret );
+		return VMC96POLLBENCH_ERROR_URING;
+	}
+
+	for( attached = 0; attached < count; attached++ )
+	{
+		i = attached;
+		ret = vmc96_uring_attach( ring, board[i].vmc96 );
+
+		if( ret != VMC96_SUCCESS )
+			goto transaction_error;
+
+		board[i].remaining = transactions;
+	}
+
+	vmc96pollbench_read_counters( &result->before );
+	enter_count = vmc96_uring_get_enter_count( ring );
+
+	for( i = 0; i < count; i++ )
+	{
+		ret = vmc96pollbench_start( &board[i] );
+
+		if( ret != VMC96_SUCCESS )
+			goto transaction_error;
+	}
+
+	active = count;
+
+	while( active > 0 )
+	{
+		/* Submits every new request and reaps every response in one system call */
+		ret = vmc96_uring_wait( ring, completion, count, &completed, VMC96POLLBENCH_POLL_TIMEOUT_MS );
+
+		if( ret != VMC96_SUCCESS )
+		{
+			fprintf( stderr, "io_uring: Error: %s (Cod: %d)\n", vmc96_get_error_code_string(ret), ret );
+			ret = VMC96POLLBENCH_ERROR_URING;
+			goto cleanup;
+		}
+
+		for( j = 0; j < completed; j++ )
+		{
+			for( i = 0; board[i].vmc96 != completion[j].vmc96; i++ );
+
+			ret = completion[j].result;
+
+			if( ret != VMC96_SUCCESS )
+				goto transaction_error;
+
+			if( vmc96pollbench_finish( result, &board[i], &ret ) )
+			{
+				active--;
+				continue;
+			}
+
+			if( ret != VMC96_SUCCESS )
+				goto transaction_error;
+		}
+	}
+
+	vmc96pollbench_read_counters( &result->after );
+
+	result->waits = vmc96_uring_get_enter_count( ring ) - enter_count;
+
+	ret = VMC96POLLBENCH_SUCCESS;
+	goto cleanup;
+
+transaction_error:
+
+	fprintf( stderr, "io_uring: %s: Error: %s (Cod: %d)\n", board[i].device, vmc96_get_error_code_string(ret), ret );
+	ret = VMC96POLLBENCH_ERROR_TRANSACTION;
+
+cleanup:
+
+	for( i = 0; i < attached; i++ )
+		vmc96_uring_detach( ring, board[i].vmc96 );
+
+	vmc96_uring_destroy( ring );
+
+	return ret;
+}
+
+
+static void vmc96pollbench_show_results( vmc96pollbench_result_t * result, int runs, int count, int transactions )
+{
+	const vmc96pollbench_counters_t * before = NULL;
+	const vmc96pollbench_counters_t * after = NULL;
+	double value[ 9 ][ 2 ];
+	double n = 0;
+	int i = 0;
+	int m = 0;
+
+	static const char * metric[ 9 ][ 2 ] =
+	{
+		{ "throughput",        "txn/s"  },
+		{ "mean_latency",      "us"     },
+		{ "max_latency",       "us"     },
+		{ "cpu_time",          "us/txn" },
+		{ "cpu_busy",          "%"      },
+		{ "context_switches",  "/txn"   },
+		{ "wait_syscalls",     "/txn"   },
+		{ "read_write_flush",  "/txn"   },
+		{ "total_syscalls",    "/txn"   }
+	};
+
+	for( i = 0; i < runs; i++ )
+	{
+		before = &result[i].before;
+		after = &result[i].after;
+		n = (double) result[i].completed;
+
+		value[0][i] = n / ((after->wall_ns - before->wall_ns) / 1e9);
+		value[1][i] = result[i].latency_sum_ns / n / 1e3;
+		value[2][i] = result[i].latency_max_ns / 1e3;
+		value[3][i] = (after->cpu_ns - before->cpu_ns) / n / 1e3;
+		value[4][i] = (after->cpu_ns - before->cpu_ns) * 100.0 / (after->wall_ns - before->wall_ns);
+		value[5][i] = (double) (after->csw - before->csw) / n;
+		value[6][i] = (double) result[i].waits / n;
+		value[7][i] = (double) (after->syscr - before->syscr + after->syscw - before->syscw + result[i].flushes) / n;
+		value[8][i] = value[6][i] + value[7][i];
+	}
+
+	fprintf( stdout, "TRANSPORT BENCHMARK (%d boards, %d transactions each, 1 thread):\n\n", count, transactions );
+	fprintf( stdout, "	%-26s %-8s", "", "" );
+
+	for( i = 0; i < runs; i++ )
+		fprintf( stdout, " %12s", result[i].name );
+
+	fprintf( stdout, "\n" );
+
+	for( m = 0; m < 9; m++ )
+	{
+		/* read()/write() counters need /proc/self/io */
+		if( (m >= 7) && !result[0].before.valid )
+			continue;
+
+		fprintf( stdout, "	%-26s %-8s", metric[m][0], metric[m][1] );
+
+		for( i = 0; i < runs; i++ )
+			fprintf( stdout, " %12.2f", value[m][i] );
+
+		fprintf( stdout, "\n" );
+	}
+
+	fprintf( stdout, "\n" );
+}
+
+
+static void vmc96pollbench_show_usage( void )
+{
+	fprintf( stderr, "Usage: vmc96pollbench [--transactions=N] [--transport=poll|uring|both] TTY [TTY ...]\n" );
+	fprintf( stderr, "	Drives every board from one thread, back-to-back status requests.\n" );
+	fprintf( stderr, "	--transactions  Status transactions per board (default: %d)\n", VMC96POLLBENCH_DEFAULT_TRANSACTIONS );
+	fprintf( stderr, "	--transport     poll(): one read()/write()/tcflush() per request and a poll() per wake-up\n" );
+	fprintf( stderr, "	                uring: one io_uring_enter() submits and reaps for all boards (default: both)\n" );
+}
+
+
+int main( int argc, char ** argv )
+{
+	int ret = 0;
+	int index = 0;
+	int transactions = VMC96POLLBENCH_DEFAULT_TRANSACTIONS;
+	int transport = VMC96POLLBENCH_TRANSPORT_BOTH;
+	vmc96pollbench_board_t board[ VMC96POLLBENCH_MAX_BOARDS ];
+	vmc96pollbench_result_t result[ 2 ];
+	int runs = 0;
+	int count = 0;
+	int i = 0;
+
+	static struct option options[] =
+	{
+		{ "transactions", required_argument, 0,  'a' },
+		{ "transport",    required_argument, 0,  'c' },
+		{ "help",         no_argument,       0,  'b' },
+		{ NULL,           no_argument,       0,   0  }
+	};
+
+	while( (ret = getopt_long( argc, argv, "a:c:b", options, &index )) != -1 )
+	{
+		switch( ret )
+		{
+			case 'a' : transactions = atoi( optarg ); break;
+
+			case 'c' :
+
+				if( !strcmp( optarg, "poll" ) )
+					transport = VMC96POLLBENCH_TRANSPORT_POLL;
+				else if( !strcmp( optarg, "uring" ) )
+					transport = VMC96POLLBENCH_TRANSPORT_URING;
+				else if( !strcmp( optarg, "both" ) )
+					transport = VMC96POLLBENCH_TRANSPORT_BOTH;
+				else
+					transport = 0;
+
+				break;
+
+			default :
+				vmc96pollbench_show_usage();
+				return VMC96POLLBENCH_ERROR_ARGS;
+		}
+	}
+
+	count = argc - optind;
+
+	if( (transactions <= 0) || !transport || (count <= 0) || (count > VMC96POLLBENCH_MAX_BOARDS) )
+	{
+		vmc96pollbench_show_usage();
+		return VMC96POLLBENCH_ERROR_ARGS;
+	}
+
+	memset( board, 0, sizeof(board) );
+	memset( result, 0, sizeof(result) );
+
+	for( i = 0; i < count; i++ )
+	{
+		board[i].device = argv[ optind + i ];
+
+		ret = vmc96_initialize_tty( &board[i].vmc96, board[i].device );
+
+		if( ret != VMC96_SUCCESS )
+		{
+			fprintf( stderr, "%s: Error: %s (Cod: %d)\n", board[i].device, vmc96_get_error_code_string(ret), ret );
+			count = i;
+			ret = VMC96POLLBENCH_ERROR_TRANSACTION;
+			goto cleanup;
+		}
+	}
+
+	/* Same boards, one transport after the other */
+	if( transport & VMC96POLLBENCH_TRANSPORT_POLL )
+	{
+		ret = vmc96pollbench_run_poll( board, count, transactions, &result[ runs ] );
+
+		if( ret != VMC96POLLBENCH_SUCCESS )
+			goto cleanup;
+
+		runs++;
+	}
+
+	if( transport & VMC96POLLBENCH_TRANSPORT_URING )
+	{
+		ret = vmc96pollbench_run_uring( board, count, transactions, &result[ runs ] );
+
+		/* Kernels without io_uring still get the poll() figures */
+		if( (ret == VMC96POLLBENCH_ERROR_URING) && runs )
+			ret = VMC96POLLBENCH_SUCCESS;
+		else if( ret != VMC96POLLBENCH_SUCCESS )
+			goto cleanup;
+		else
+			runs++;
+	}
+
+	vmc96pollbench_show_results( result, runs, count, transactions );
+
+	ret = VMC96POLLBENCH_SUCCESS;
+
+cleanup:
+
+	for( i = 0; i < count; i++ )
+		vmc96_finish( board[i].vmc96 );
+
+	return ret;
+}
+
+/* eof */
@@ -44,8 +44,8 @@ int vend( VMC96_t * vmc96, unsigned int mrow, unsigned char mcol )
 	int trials = 0;
 	VMC96_opto_line_sample_block_t opto_line;
 
-	/* Reset Motor Array */
-	ret = vmc96_motor_reset( vmc96 );
+	/* Reset/Probe Motor Array only if its state is not known to be idle */
+	ret = vmc96_motor_prepare( vmc96 );
 
 	if( ret != VMC96_SUCCESS )
 		return VEND_ERROR;
@@ -113,6 +113,8 @@ int main( int argc, char ** argv )
 		return EXIT_FAILURE;
 	};
 
+	vmc96_set_session( vmc96, 1 );
+
 	ret = vend( vmc96, 0, 0 );
 
 	if( ret != VEND_OK )
@@ -0,0 +1,144 @@
+/*!
+	\file coroutine_vend.cpp
+	\brief Example: Straight-line vend coroutines on several TTY boards, one thread (C++20)
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "vmc96.hpp"
+
+#define VEND_ERROR       (-2)
+#define VEND_TIMEOUT     (-1)
+#define VEND_OK          (0)
+
+#define VENDS_PER_BOARD  (3)
+
+vmc96::Task vend( vmc96::Board & board, int * outcome )
+{
+	int i = 0;
+	int trials = 0;
+	unsigned char mcol = 0;
+
+	for( mcol = 0; mcol < VENDS_PER_BOARD; mcol++ )
+	{
+		outcome[ mcol ] = VEND_ERROR;
+
+		/* Reset/Probe Motor Array only if its state is not known to be idle */
+		if( !co_await board.motor_prepare() )
+			co_return;
+
+		/* Run Desired Product Motor */
+		if( !co_await board.motor_run( 0, mcol ) )
+			co_return;
+
+		/* Read consecutive Opto Line sample blocks until the product drops */
+		vmc96::OptoStream opto( board );
+
+		for( trials = 0; trials < 5; trials++ )
+		{
+			auto opto_line = co_await opto.next();
+
+			if( !opto_line )
+				break;
+
+			for( i = 0; i < VMC96_OPTO_LINE_SAMPLES_PER_BLOCK; i++ )
+				if( opto_line.value.sample[i] )
+					break;
+
+			if( i < VMC96_OPTO_LINE_SAMPLES_PER_BLOCK )
+			{
+				outcome[ mcol ] = VEND_OK;
+				break;
+			}
+
+			outcome[ mcol ] = VEND_TIMEOUT;
+		}
+
+		/* Stop All Motors */
+		co_await board.motor_stop_all();
+	}
+}
+
+
+int main( int argc, char ** argv )
+{
+	int i = 0;
+	int j = 0;
+	int ret = EXIT_SUCCESS;
+	vmc96::Executor executor;
+	std::vector< std::unique_ptr<vmc96::Board> > boards;
+	std::vector<int> outcome;
+
+	if( argc < 2 )
+	{
+		fprintf( stderr, "Usage: %s /dev/ttyUSB0 [/dev/ttyUSB1 ...]\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		for( i = 1; i < argc; i++ )
+		{
+			boards.push_back( std::make_unique<vmc96::Board>( executor, argv[i] ) );
+			boards.back()->set_session( true );
+		}
+	}
+	catch( const std::exception & e )
+	{
+		fprintf( stderr, "%s: Error: %s\n", argv[i], e.what() );
+		return EXIT_FAILURE;
+	}
+
+	outcome.resize( boards.size() * VENDS_PER_BOARD );
+
+	/* Every board runs up to its first co_await, then the executor drives them all */
+	for( i = 0; i < (int) boards.size(); i++ )
+		vend( *boards[i], &outcome[ i * VENDS_PER_BOARD ] );
+
+	executor.run();
+
+	for( i = 0; i < (int) boards.size(); i++ )
+	{
+		for( j = 0; j < VENDS_PER_BOARD; j++ )
+		{
+			if( outcome[ i * VENDS_PER_BOARD + j ] == VEND_OK )
+			{
+				fprintf( stdout, "%s: Motor (0,%d): Vend OK!\n", argv[ i + 1 ], j );
+				continue;
+			}
+
+			fprintf( stderr, "%s: Motor (0,%d): %s\n", argv[ i + 1 ], j, ( outcome[ i * VENDS_PER_BOARD + j ] == VEND_TIMEOUT ) ? "Vend Timeout!" : "Vend Error!" );
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	return ret;
+}
+
+/* eof */
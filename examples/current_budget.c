@@ -0,0 +1,177 @@
+/*!
+	\file current_budget.c
+	\brief Example: Share one Current Limit across Boards and Check it is Never Exceeded
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "vmc96api.h"
+#include "vmc96budget.h"
+
+#define MAX_BOARDS           (8)
+#define LIMIT_MA             (300)
+#define MOTOR_ESTIMATE_MA    (150)
+#define RUNS_PER_ROUND       (2)
+#define SERVICE_PERIOD_MS    (100)
+
+static int g_released = 0;
+
+static void run_released( VMC96_t * vmc96, unsigned char row, unsigned char col, int result, void * arg )
+{
+	fprintf( stdout, "Queued run [%d,%d] released: %s\n", row, col, vmc96_get_error_code_string(result) );
+	g_released++;
+}
+
+/* Read every board and compare the real machine-wide current with the limit */
+static int check_limit( VMC96_t ** vmc96, int count )
+{
+	VMC96_motor_array_status_t status;
+	unsigned int total_ma = 0;
+	int i = 0;
+
+	for( i = 0; i < count; i++ )
+	{
+		if( vmc96_motor_get_status( vmc96[i], &status ) != VMC96_SUCCESS )
+			return 0;
+
+		total_ma += status.current_ma;
+	}
+
+	if( total_ma > LIMIT_MA )
+	{
+		fprintf( stderr, "Budget violated: %dmA measured, limit is %dmA!\n", total_ma, LIMIT_MA );
+		return 0;
+	}
+
+	return 1;
+}
+
+int main( int argc, char ** argv )
+{
+	int i = 0;
+	int j = 0;
+	int ret = 0;
+	int count = 0;
+	int queued = 0;
+	VMC96_t * vmc96[ MAX_BOARDS ];
+	VMC96_budget_t * budget = NULL;
+
+	if( argc < 2 )
+	{
+		fprintf( stderr, "Usage: %s /dev/ttyUSB0 [/dev/ttyUSB1 ...]\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	count = ( argc - 1 < MAX_BOARDS ) ? argc - 1 : MAX_BOARDS;
+
+	ret = vmc96_budget_create( &budget, LIMIT_MA, MOTOR_ESTIMATE_MA );
+
+	if( ret != VMC96_SUCCESS )
+		goto error;
+
+	for( i = 0; i < count; i++ )
+	{
+		ret = vmc96_initialize_tty( &vmc96[i], argv[ i + 1 ] );
+
+		if( ret != VMC96_SUCCESS )
+		{
+			count = i;
+			goto error;
+		}
+
+		vmc96_budget_attach( budget, vmc96[i] );
+	}
+
+	/* Ask for more runs than fit in two rounds, staying away from vmc96_budget_service()
+	   in between: runs of the first round keep their reservations until a board reports them */
+	for( j = 0; j < 2 * RUNS_PER_ROUND; j++ )
+	{
+		if( j == RUNS_PER_ROUND )
+			usleep( (VMC96_BUDGET_RESERVATION_TIMEOUT_MS + SERVICE_PERIOD_MS) * 1000L );
+
+		for( i = 0; i < count; i++ )
+		{
+			ret = vmc96_budget_motor_run( budget, vmc96[i], 0, j, run_released, NULL );
+
+			if( ret == VMC96_ERROR_BUDGET_RUN_QUEUED )
+				queued++;
+			else if( ret != VMC96_SUCCESS )
+				goto error;
+		}
+	}
+
+	if( !check_limit( vmc96, count ) )
+		goto violated;
+
+	/* Release queued runs as current becomes available */
+	while( g_released < queued )
+	{
+		ret = vmc96_budget_service( budget );
+
+		if( ret != VMC96_SUCCESS )
+			goto error;
+
+		if( !check_limit( vmc96, count ) )
+			goto violated;
+
+		usleep( SERVICE_PERIOD_MS * 1000L );
+	}
+
+	fprintf( stdout, "%d run(s) queued and released, limit of %dmA never exceeded.\n", queued, LIMIT_MA );
+
+	for( i = 0; i < count; i++ )
+	{
+		vmc96_budget_detach( budget, vmc96[i] );
+		vmc96_finish( vmc96[i] );
+	}
+
+	vmc96_budget_destroy( budget );
+	return EXIT_SUCCESS;
+
+error:
+
+	/* Display error details */
+	fprintf( stderr, "Error: %s (Cod: %d)\n", vmc96_get_error_code_string(ret), ret );
+
+violated:
+
+	for( i = 0; i < count; i++ )
+	{
+		if( budget )
+			vmc96_budget_detach( budget, vmc96[i] );
+
+		vmc96_finish( vmc96[i] );
+	}
+
+	if( budget )
+		vmc96_budget_destroy( budget );
+
+	return EXIT_FAILURE;
+}
+
+/* eof */
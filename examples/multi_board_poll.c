@@ -0,0 +1,121 @@
+/*!
+	\file multi_board_poll.c
+	\brief Example: Drive several TTY attached boards from a single thread
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <poll.h>
+
+#include "vmc96api.h"
+
+#define MAX_BOARDS    (32)
+
+int main( int argc, char ** argv )
+{
+	int i = 0;
+	int ret = 0;
+	int count = 0;
+	int pending = 0;
+	VMC96_t * vmc96[ MAX_BOARDS ];
+	VMC96_motor_array_status_t status[ MAX_BOARDS ];
+	struct pollfd pfd[ MAX_BOARDS ];
+
+	if( argc < 2 )
+	{
+		fprintf( stderr, "Usage: %s /dev/ttyUSB0 [/dev/ttyUSB1 ...]\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	count = ( argc - 1 < MAX_BOARDS ) ? argc - 1 : MAX_BOARDS;
+
+	for( i = 0; i < count; i++ )
+	{
+		ret = vmc96_initialize_tty( &vmc96[i], argv[ i + 1 ] );
+
+		if( ret != VMC96_SUCCESS )
+		{
+			fprintf( stderr, "%s: Error: %s (Cod: %d)\n", argv[ i + 1 ], vmc96_get_error_code_string(ret), ret );
+			count = i;
+			goto cleanup;
+		}
+
+		vmc96_set_nonblocking( vmc96[i], 1 );
+
+		pfd[i].fd = vmc96_get_fd( vmc96[i] );
+		pfd[i].events = POLLIN;
+	}
+
+	/* Send all requests at once */
+	for( i = 0; i < count; i++ )
+	{
+		ret = vmc96_motor_get_status( vmc96[i], &status[i] );
+
+		if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+			pending++;
+		else
+			pfd[i].fd = -1;
+	}
+
+	/* Complete them as responses arrive */
+	while( pending > 0 )
+	{
+		/* Requests the TTY could not take at once are finished by vmc96_poll() */
+		for( i = 0; i < count; i++ )
+			if( pfd[i].fd >= 0 )
+				pfd[i].events = ( vmc96_write_pending( vmc96[i] ) ) ? (POLLIN | POLLOUT) : POLLIN;
+
+		poll( pfd, count, 10 );
+
+		for( i = 0; i < count; i++ )
+		{
+			if( pfd[i].fd < 0 )
+				continue;
+
+			ret = vmc96_poll( vmc96[i] );
+
+			if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+				continue;
+
+			if( ret == VMC96_SUCCESS )
+				fprintf( stdout, "%s: %d active motor(s), %dmA\n", argv[ i + 1 ], status[i].active_count, status[i].current_ma );
+			else
+				fprintf( stderr, "%s: Error: %s (Cod: %d)\n", argv[ i + 1 ], vmc96_get_error_code_string(ret), ret );
+
+			pfd[i].fd = -1;
+			pending--;
+		}
+	}
+
+cleanup:
+
+	for( i = 0; i < count; i++ )
+		vmc96_finish( vmc96[i] );
+
+	return ( ret == VMC96_SUCCESS ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
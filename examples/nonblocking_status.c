@@ -0,0 +1,87 @@
+/*!
+	\file nonblocking_status.c
+	\brief Example: Non-Blocking Motor Array Status Polling
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "vmc96api.h"
+
+#define STATUS_POLL_INTERVAL_MS    (5)
+
+int main( int argc, char ** argv )
+{
+	int ret = 0;
+	unsigned long idle_loops = 0;
+	VMC96_t * vmc96 = NULL;
+	VMC96_motor_array_status_t status;
+
+	ret = vmc96_initialize( &vmc96 );
+
+	if( ret != VMC96_SUCCESS )
+		goto error;
+
+	ret = vmc96_set_nonblocking( vmc96, 1 );
+
+	if( ret != VMC96_SUCCESS )
+		goto error;
+
+	/* Send the request; status is filled in when the transaction completes */
+	ret = vmc96_motor_get_status( vmc96, &status );
+
+	while( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+	{
+		/* The thread is free to serve other boards/events here */
+		idle_loops++;
+		usleep( STATUS_POLL_INTERVAL_MS * 1000L );
+
+		ret = vmc96_poll( vmc96 );
+	}
+
+	if( ret != VMC96_SUCCESS )
+		goto error;
+
+	fprintf( stdout, "MOTOR ARRAY STATUS:\n\n");
+	fprintf( stdout, "	Active Motors: %d\n", status.active_count );
+	fprintf( stdout, "	Current: %dmA\n", status.current_ma );
+	fprintf( stdout, "	Idle Loops While Waiting: %lu\n\n", idle_loops );
+
+	vmc96_finish( vmc96 );
+	return EXIT_SUCCESS;
+
+error:
+
+	/* Display error details */
+	fprintf( stderr, "Error: %s (Cod: %d)\n", vmc96_get_error_code_string(ret), ret );
+
+	if( vmc96 )
+		vmc96_finish( vmc96 );
+	return EXIT_FAILURE;
+}
+
+/* eof */
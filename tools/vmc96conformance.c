@@ -0,0 +1,221 @@
+/*!
+	\file vmc96conformance.c
+	\brief Conformance Driver: runs Scenario Steps read from stdin through the C Library
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vmc96api.h"
+
+
+/* ********************************************************************* */
+/* *                              DEFINES                              * */
+/* ********************************************************************* */
+
+#define VMC96CONFORMANCE_LINE_MAX_LEN                     (256)
+#define VMC96CONFORMANCE_RESULT_MAX_LEN                   (1024)
+#define VMC96CONFORMANCE_OP_MAX_LEN                       (32)
+
+
+/* ********************************************************************* */
+/* *                          IMPLEMENTATION                           * */
+/* ********************************************************************* */
+
+static double vmc96conformance_now_us( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return (double) ts.tv_sec * 1e6 + (double) ts.tv_nsec / 1e3;
+}
+
+
+static void vmc96conformance_format_array( char * out, const VMC96_motor_array_t * array )
+{
+	unsigned char row = 0;
+	unsigned char col = 0;
+	const char * sep = "";
+
+	for( row = 0; row < VMC96_MOTOR_ARRAY_ROWS_COUNT; row++ )
+	{
+		for( col = 0; col < VMC96_MOTOR_ARRAY_COLUMNS_COUNT; col++ )
+		{
+			if( !array->motor[ row ][ col ] )
+				continue;
+
+			out += sprintf( out, "%s%d.%d", sep, row, col );
+			sep = " ";
+		}
+	}
+}
+
+
+/* Runs one step and writes its canonical result (same format as tools/vmc96conformance.py) */
+static int vmc96conformance_run_step( VMC96_t * vmc96, const char * op, const int * a, char * out )
+{
+	char version[ VMC96_VERSION_STRING_MAX_LEN + 1 ] = {0};
+	VMC96_motor_array_status_t status;
+	VMC96_opto_line_sample_block_t block;
+	VMC96_motor_array_scan_result_t scan;
+	int ret = 0;
+	int i = 0;
+
+	strcpy( out, "ok" );
+
+	if( !strcmp( op, "global_reset" ) )
+		return vmc96_global_reset( vmc96 );
+
+	if( !strcmp( op, "relay_ping" ) )
+		return vmc96_relay_ping( vmc96, a[0] );
+
+	if( !strcmp( op, "relay_reset" ) )
+		return vmc96_relay_reset( vmc96, a[0] );
+
+	if( !strcmp( op, "relay_control" ) )
+		return vmc96_relay_control( vmc96, a[0], a[1] );
+
+	if( !strcmp( op, "motor_ping" ) )
+		return vmc96_motor_ping( vmc96 );
+
+	if( !strcmp( op, "motor_reset" ) )
+		return vmc96_motor_reset( vmc96 );
+
+	if( !strcmp( op, "motor_stop_all" ) )
+		return vmc96_motor_stop_all( vmc96 );
+
+	if( !strcmp( op, "motor_run" ) )
+		return vmc96_motor_run( vmc96, a[0], a[1] );
+
+	if( !strcmp( op, "motor_pair_run" ) )
+		return vmc96_motor_pair_run( vmc96, a[0], a[1], a[2] );
+
+	if( !strcmp( op, "motor_give_pulse" ) )
+		return vmc96_motor_give_pulse( vmc96, a[0], a[1], a[2] );
+
+	if( !strcmp( op, "relay_version" ) || !strcmp( op, "motor_version" ) )
+	{
+		if( op[0] == 'r' )
+			ret = vmc96_relay_get_version( vmc96, a[0], version );
+		else
+			ret = vmc96_motor_get_version( vmc96, version );
+
+		sprintf( out, "version:%s", version );
+		return ret;
+	}
+
+	if( !strcmp( op, "motor_status" ) )
+	{
+		ret = vmc96_motor_get_status( vmc96, &status );
+
+		out += sprintf( out, "status:active=%d,current=%d,motors=", status.active_count, status.current_ma );
+		vmc96conformance_format_array( out, &status.array );
+		return ret;
+	}
+
+	if( !strcmp( op, "opto" ) )
+	{
+		ret = vmc96_motor_opto_line_status( vmc96, &block );
+
+		out += sprintf( out, "opto:" );
+
+		for( i = 0; i < VMC96_OPTO_LINE_SAMPLES_PER_BLOCK; i++ )
+			*out++ = ( block.sample[i] ) ? '1' : '0';
+
+		*out = '\0';
+		return ret;
+	}
+
+	if( !strcmp( op, "scan" ) )
+	{
+		ret = vmc96_motor_scan_array( vmc96, &scan );
+
+		out += sprintf( out, "scan:count=%d,motors=", scan.count );
+		vmc96conformance_format_array( out, &scan.array );
+		return ret;
+	}
+
+	sprintf( out, "unknown-step:%s", op );
+	return VMC96_SUCCESS;
+}
+
+
+int main( int argc, char ** argv )
+{
+	char line[ VMC96CONFORMANCE_LINE_MAX_LEN ];
+	char op[ VMC96CONFORMANCE_OP_MAX_LEN ];
+	char result[ VMC96CONFORMANCE_RESULT_MAX_LEN ];
+	int a[3] = { 0, 0, 0 };
+	double started_us = 0;
+	double latency_us = 0;
+	VMC96_t * vmc96 = NULL;
+	int ret = 0;
+
+	if( argc != 2 )
+	{
+		fprintf( stderr, "Usage: %s TTY < steps\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	ret = vmc96_initialize_tty( &vmc96, argv[1] );
+
+	if( ret != VMC96_SUCCESS )
+	{
+		fprintf( stderr, "Error: %s (Cod: %d)\n", vmc96_get_error_code_string(ret), ret );
+		return EXIT_FAILURE;
+	}
+
+	/* One step per line: <op> [arg ...]; one result per line: <result|error:code> <latency_us> */
+	while( fgets( line, sizeof(line), stdin ) )
+	{
+		a[0] = a[1] = a[2] = 0;
+
+		if( sscanf( line, "%31s %d %d %d", op, &a[0], &a[1], &a[2] ) < 1 )
+			continue;
+
+		started_us = vmc96conformance_now_us();
+
+		ret = vmc96conformance_run_step( vmc96, op, a, result );
+
+		latency_us = vmc96conformance_now_us() - started_us;
+
+		/* Failures are compared by error code */
+		if( ret != VMC96_SUCCESS )
+			sprintf( result, "error:%d", ret );
+
+		fprintf( stdout, "%s %.1f\n", result, latency_us );
+		fflush( stdout );
+	}
+
+	vmc96_finish( vmc96 );
+
+	return EXIT_SUCCESS;
+}
+
+/* eof */
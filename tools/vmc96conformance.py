@@ -0,0 +1,352 @@
+#
+#	\file vmc96conformance.py
+#	\brief Cross-Implementation Conformance Suite (C Library, vmc96cli, VMC96.py)
+#	\author Tiago Ventura (tiago.ventura@gmail.com)
+#	\date Oct.2026
+#
+#
+#	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+#
+#	Permission is hereby granted, free of charge, to any person obtaining a copy
+#	of this software and associated documentation files (the "Software"), to deal
+#	in the Software without restriction, including without limitation the rights
+#	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+#	copies of the Software, and to permit persons to whom the Software is
+#	furnished to do so, subject to the following conditions:
+#
+#	The above copyright notice and this permission notice shall be included in
+#	all copies or substantial portions of the Software.
+#
+#	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+#	THE SOFTWARE.
+#
+#	Usage:
+#
+#		$ make conformance
+#		$ python3 tools/vmc96conformance.py --cli=./bin/vmc96cli --driver=./bin/vmc96conformance [--fragment=2]
+#
+#	Runs one scenario through every implementation, each against its own fresh
+#	simulated board (tools/vmc96sim.py). Every step must produce byte-identical
+#	request/response frames and the same decoded result as the C library, and
+#	failures must carry the same VMC96 error code. Steps prefixed with a fault
+#	("nak:", "corrupt:", "silent:") get a spoiled response from the simulator.
+#	In-process step latency is reported for the C library and VMC96.py; CLI
+#	invocations (fork/exec and board initialization included) are reported
+#	apart. Exits with 1 on any mismatch.
+#
+import os
+import re
+import sys
+import time
+import argparse
+import threading
+import subprocess
+
+sys.path.insert( 0, os.path.join( os.path.dirname( os.path.abspath( __file__ ) ), ".." ) )
+sys.path.insert( 0, os.path.dirname( os.path.abspath( __file__ ) ) )
+
+import VMC96
+from vmc96sim import VMC96Simulator
+
+
+# Motors keep running for the whole scenario, so results never depend on timing
+SIM_RUN_MS = 600000
+
+SCENARIO = [
+	( "global_reset", ),
+	( "relay_ping", 0 ),
+	( "relay_ping", 1 ),
+	( "relay_version", 0 ),
+	( "relay_control", 1, 1 ),
+	( "relay_reset", 1 ),
+	( "motor_ping", ),
+	( "motor_version", ),
+	( "motor_reset", ),
+	( "motor_status", ),
+	( "opto", ),
+	( "motor_run", 0, 0 ),
+	( "motor_pair_run", 2, 3, 11 ),
+	( "motor_status", ),
+	( "opto", ),
+	( "scan", ),
+	( "motor_stop_all", ),
+	( "motor_status", ),
+	( "motor_give_pulse", 7, 11, 200 ),
+	( "motor_stop_all", ),
+	( "motor_run", 8, 0 ),
+	( "motor_give_pulse", 0, 12, 10 ),
+	( "motor_pair_run", 0, 1, 12 ),
+	( "motor_status", ),
+	( "nak:motor_ping", ),
+	( "corrupt:motor_status", ),
+	( "nak:motor_run", 1, 1 ),
+	( "motor_status", ),
+	( "corrupt:motor_version", ),
+	( "silent:relay_ping", 0 ),
+	( "motor_ping", ),
+]
+
+
+def split_fault( step ):
+	fault, _, op = step[0].rpartition( ":" )
+	return ( fault or None ), ( op, ) + tuple( step[1:] )
+
+
+def format_motors( pairs ):
+	return " ".join( "{}.{}".format( r, c ) for r, c in sorted( pairs ) )
+
+
+def motor_id_to_pair( mid ):
+	return ( (mid >> 4) - 1, (mid & 0x0F) - 1 )
+
+
+# *********************************************************************
+# *                         IMPLEMENTATIONS                           *
+# *********************************************************************
+
+class Implementation( object ):
+
+	def __init__( self, name, in_process=True ):
+		self.name = name
+		self.in_process = in_process
+
+	def start( self, tty ):
+		pass
+
+	def run( self, step ):
+		raise NotImplementedError()
+
+	def stop( self ):
+		pass
+
+
+class CLibrary( Implementation ):
+
+	def __init__( self, driver ):
+		Implementation.__init__( self, "c-library" )
+		self.driver = driver
+
+	def start( self, tty ):
+		self.proc = subprocess.Popen( [ self.driver, tty ], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True )
+
+	def run( self, step ):
+		self.proc.stdin.write( " ".join( str(s) for s in step ) + "\n" )
+		self.proc.stdin.flush()
+		result, latency_us = self.proc.stdout.readline().rsplit( " ", 1 )
+		return result, float( latency_us )
+
+	def stop( self ):
+		self.proc.stdin.close()
+		self.proc.wait()
+
+
+class Python( Implementation ):
+
+	def __init__( self ):
+		Implementation.__init__( self, "python" )
+
+	def start( self, tty ):
+		self.vm = VMC96.VMC96( device=tty )
+
+	def _call( self, step ):
+		vm = self.vm
+		op, a = step[0], step[1:]
+		if( op == "global_reset" ):
+			vm.global_reset()
+		elif( op == "relay_ping" ):
+			vm.relay_ping( a[0] )
+		elif( op == "relay_reset" ):
+			vm.relay_reset( a[0] )
+		elif( op == "relay_control" ):
+			vm.relay_set_state( a[0], a[1] )
+		elif( op == "relay_version" ):
+			return "version:" + vm.relay_get_version( a[0] )
+		elif( op == "motor_ping" ):
+			vm.motor_ping()
+		elif( op == "motor_version" ):
+			return "version:" + vm.motor_get_version()
+		elif( op == "motor_reset" ):
+			vm.motor_reset()
+		elif( op == "motor_stop_all" ):
+			vm.motor_stop_all()
+		elif( op == "motor_run" ):
+			vm.motor_run( vm._motor_id( a[0], a[1] ) )
+		elif( op == "motor_pair_run" ):
+			vm.motor_pair_run( vm._motor_id( a[0], a[1] ), vm._motor_id( a[0], a[2] ) )
+		elif( op == "motor_give_pulse" ):
+			vm.motor_give_pulse( vm._motor_id( a[0], a[1] ), a[2] )
+		elif( op == "motor_status" ):
+			status = vm.motor_get_status()
+			motors = format_motors( [ motor_id_to_pair( m ) for m in status["running_motors"] ] )
+			return "status:active={},current={},motors={}".format( status["active_count"], status["current_ma"], motors )
+		elif( op == "opto" ):
+			return "opto:" + "".join( str(s) for s in vm.opto_sensor_read() )
+		elif( op == "scan" ):
+			scan = vm.motor_scan_array()
+			motors = format_motors( [ motor_id_to_pair( m ) for m in scan["available_motors"] ] )
+			return "scan:count={},motors={}".format( scan["count"], motors )
+		else:
+			return "unknown-step:" + op
+		return "ok"
+
+	def run( self, step ):
+		started = time.monotonic()
+		try:
+			result = self._call( step )
+		except VMC96.VMC96Error as e:
+			result = "error:{}".format( e.code )
+		return result, ( time.monotonic() - started ) * 1e6
+
+	def stop( self ):
+		self.vm.close()
+
+
+class CommandLine( Implementation ):
+
+	_RELAYS = [ "RELAY1", "RELAY2" ]
+
+	def __init__( self, cli ):
+		Implementation.__init__( self, "cli", in_process=False )
+		self.cli = cli
+
+	def start( self, tty ):
+		self.tty = tty
+
+	def _arguments( self, step ):
+		op, a = step[0], step[1:]
+		if( op == "global_reset" ):
+			return [ "--controller=GLOBAL", "--command=RESET" ]
+		if( op.startswith( "relay_" ) ):
+			args = [ "--controller=" + CommandLine._RELAYS[ a[0] ] ]
+			if( op == "relay_control" ):
+				return args + [ "--command=CONTROL", "--state={}".format( a[1] ) ]
+			return args + [ "--command=" + { "relay_ping": "PING", "relay_reset": "RESET", "relay_version": "VERSION" }[ op ] ]
+		args = [ "--controller=MOTOR_ARRAY" ]
+		if( op == "motor_run" ):
+			return args + [ "--command=RUN", "--row={}".format( a[0] ), "--column={}".format( a[1] ) ]
+		if( op == "motor_pair_run" ):
+			return args + [ "--command=RUN_PAIR", "--row={}".format( a[0] ), "--column1={}".format( a[1] ), "--column2={}".format( a[2] ) ]
+		if( op == "motor_give_pulse" ):
+			return args + [ "--command=GIVE_PULSE", "--row={}".format( a[0] ), "--column={}".format( a[1] ), "--duration={}".format( a[2] ) ]
+		return args + [ "--command=" + { "motor_ping": "PING", "motor_version": "VERSION", "motor_reset": "RESET", "motor_stop_all": "STOP_ALL",
+		                                 "motor_status": "STATUS", "opto": "OPTO_LINE_STATUS", "scan": "SCAN" }[ op ] ]
+
+	def _array( self, lines, title ):
+		# Rows of 'M'/'*' tokens printed right after the title line
+		start = [ i for i, l in enumerate( lines ) if l.strip() == title ][0] + 1
+		pairs = []
+		for row, line in enumerate( lines[ start:start + 8 ] ):
+			pairs += [ ( row, col ) for col, tok in enumerate( line.split() ) if tok == "M" ]
+		return format_motors( pairs )
+
+	def _value( self, lines, label ):
+		return [ l.split( ":", 1 )[1].strip() for l in lines if l.strip().startswith( label ) ][0]
+
+	def _result( self, op, out ):
+		lines = out.splitlines()
+		if( op in ( "relay_version", "motor_version" ) ):
+			return "version:" + self._value( lines, "Version:" )
+		if( op == "motor_status" ):
+			return "status:active={},current={},motors={}".format( self._value( lines, "Active Motors Count:" ),
+			                                                       self._value( lines, "Total Current Drained:" ).rstrip( "mA" ),
+			                                                       self._array( lines, "Array:" ) )
+		if( op == "opto" ):
+			status = [ i for i, l in enumerate( lines ) if l.strip() == "Status:" ][0]
+			return "opto:" + lines[ status + 1 ].strip().replace( ".", "" )
+		if( op == "scan" ):
+			return "scan:count={},motors={}".format( self._value( lines, "Motors Count:" ), self._array( lines, "Motor Array:" ) )
+		return "ok"
+
+	def run( self, step ):
+		started = time.monotonic()
+		proc = subprocess.run( [ self.cli, "--device=" + self.tty ] + self._arguments( step ), stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True )
+		latency_us = ( time.monotonic() - started ) * 1e6
+		if( proc.returncode != 0 ):
+			# Library failures are printed as "Error: (<code>) <description>"
+			code = re.search( r"Error: \((\d+)\)", proc.stderr )
+			return ( "error:" + code.group(1) if code else "error:exit-{}".format( proc.returncode ) ), latency_us
+		return self._result( step[0], proc.stdout ), latency_us
+
+
+# *********************************************************************
+# *                            TEST RUNNER                            *
+# *********************************************************************
+
+def run_scenario( impl, fragment ):
+	sim = VMC96Simulator( run_ms=SIM_RUN_MS, fragment=fragment )
+	done = threading.Event()
+	server = threading.Thread( target=sim.serve, args=( lambda: not done.is_set(), ) )
+	server.start()
+
+	steps = []
+	try:
+		impl.start( sim.tty )
+		for step in SCENARIO:
+			fault, call = split_fault( step )
+			first = len( sim.transactions )
+			sim.fault = fault
+			result, latency_us = impl.run( call )
+			sim.fault = None
+			steps.append( { "result": result, "latency_us": latency_us, "frames": sim.transactions[ first: ] } )
+		impl.stop()
+	finally:
+		done.set()
+		server.join()
+
+	return steps
+
+
+def format_frames( frames ):
+	if( not frames ):
+		return "(no frames)"
+	return "; ".join( "{} -> {}".format( sim_hex( req ), sim_hex( resp ) ) for req, resp in frames )
+
+
+def sim_hex( frame ):
+	return " ".join( "{:02X}".format(b) for b in frame ) if frame else "(none)"
+
+
+def main():
+	parser = argparse.ArgumentParser( description="Run one scenario through the C library, vmc96cli and VMC96.py against simulated boards." )
+	parser.add_argument( "--cli", default="./bin/vmc96cli", help="vmc96cli executable" )
+	parser.add_argument( "--driver", default="./bin/vmc96conformance", help="C library conformance driver executable" )
+	parser.add_argument( "--fragment", type=int, default=0, help="split simulated responses in chunks of N bytes" )
+	args = parser.parse_args()
+
+	impls = [ CLibrary( args.driver ), CommandLine( args.cli ), Python() ]
+	runs = [ ( impl, run_scenario( impl, args.fragment ) ) for impl in impls ]
+	reference = runs[0][1]
+	mismatches = 0
+
+	for impl, steps in runs[1:]:
+		for i, ( ref, got ) in enumerate( zip( reference, steps ) ):
+			where = "step {} {}: {}".format( i, " ".join( str(s) for s in SCENARIO[i] ), impl.name )
+			if( got["frames"] != ref["frames"] ):
+				print( where + " frames differ\n\t{}: {}\n\t{}: {}".format( runs[0][0].name, format_frames( ref["frames"] ), impl.name, format_frames( got["frames"] ) ) )
+				mismatches += 1
+			if( got["result"] != ref["result"] ):
+				print( where + " result differs\n\t{}: {}\n\t{}: {}".format( runs[0][0].name, ref["result"], impl.name, got["result"] ) )
+				mismatches += 1
+
+	print( "VMC96 CONFORMANCE ({} steps, fragment={}):".format( len(SCENARIO), args.fragment ) )
+	for in_process, title in ( ( True, "Step latency (in-process):" ), ( False, "Invocation time (process start and board init included, not comparable):" ) ):
+		print( "\n\t" + title )
+		for impl, steps in runs:
+			if( impl.in_process != in_process ):
+				continue
+			latencies = sorted( s["latency_us"] for s in steps )
+			print( "\t\t{:<12} mean {:10.1f} us   median {:10.1f} us   max {:10.1f} us".format( impl.name, sum(latencies) / len(latencies), latencies[ len(latencies) // 2 ], latencies[-1] ) )
+	print( "\n\t{}\n".format( "PASS" if mismatches == 0 else "FAIL: {} mismatch(es)".format( mismatches ) ) )
+
+	return 0 if mismatches == 0 else 1
+
+
+if __name__ == "__main__":
+	sys.exit( main() )
+
+# end-of-file #
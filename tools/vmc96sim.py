@@ -0,0 +1,288 @@
+#
+#	\file vmc96sim.py
+#	\brief Simulated VMC96 Board on a pseudo-terminal (K1 Protocol)
+#	\author Tiago Ventura (tiago.ventura@gmail.com)
+#	\date Oct.2026
+#
+#
+#	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+#
+#	Permission is hereby granted, free of charge, to any person obtaining a copy
+#	of this software and associated documentation files (the "Software"), to deal
+#	in the Software without restriction, including without limitation the rights
+#	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+#	copies of the Software, and to permit persons to whom the Software is
+#	furnished to do so, subject to the following conditions:
+#
+#	The above copyright notice and this permission notice shall be included in
+#	all copies or substantial portions of the Software.
+#
+#	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+#	THE SOFTWARE.
+#
+#	Usage:
+#
+#		Serve until interrupted, printing the TTY path to connect to:
+#			$ python3 tools/vmc96sim.py
+#
+#		Run a client against the simulated board ('{tty}' is replaced by its path):
+#			$ python3 tools/vmc96sim.py --trace=cli.txt -- ./bin/vmc96cli --device={tty} --controller=MOTOR_ARRAY --command=STATUS
+#			$ python3 tools/vmc96sim.py --trace=py.txt -- python3 -c "import VMC96; print(VMC96.VMC96(device='{tty}').motor_get_status())"
+#
+#		Serve several boards at once ('{ttys}' expands to one argument per TTY path):
+#			$ python3 tools/vmc96sim.py --boards=8 -- ./bin/vmc96pollbench {ttys}
+#
+#	Setting 'fault' on a simulator ("nak", "corrupt" or "silent") spoils its next
+#	response only: a negative ACK, a frame with a bad checksum, or no reply at all.
+#
+#	Every transaction is traced as: <request> -> <response> and the client turnaround
+#	time (from the previous response to this request). Traces of the C library, the
+#	CLI and VMC96.py running the same scenario are expected to be byte-identical in
+#	their frame columns.
+#
+import os
+import pty
+import sys
+import time
+import select
+import argparse
+import threading
+import subprocess
+
+
+class VMC96Simulator( object ):
+
+	_STX                        = 0x35
+	_MIN_LENGTH                 = 5
+
+	_CONTROLLER_GLOBAL          = 0x00
+	_CONTROLLER_RELAY_1         = 0x26
+	_CONTROLLER_RELAY_2         = 0x27
+	_CONTROLLER_MOTOR           = 0x30
+
+	_COMMAND_SIMPLE_PING        = 0x00
+	_COMMAND_GLOBAL_RESET       = 0x01
+	_COMMAND_KERNEL_VERSION     = 0x02
+	_COMMAND_RESET              = 0x05
+	_COMMAND_RELAY_FUNCTION     = 0x11
+	_COMMAND_MOTOR_STATUS       = 0x10
+	_COMMAND_MOTOR_SCAN_ARRAY   = 0x11
+	_COMMAND_MOTOR_STOP_ALL     = 0x12
+	_COMMAND_MOTOR_RUN          = 0x13
+	_COMMAND_MOTOR_GIVE_PULSE   = 0x14
+	_COMMAND_MOTOR_OPTO_STATUS  = 0x15
+
+	_ROWS                       = 8
+	_COLUMNS                    = 12
+	_MAX_CURRENT_READING_MA     = 500
+
+	_FAULTS                     = ( "nak", "corrupt", "silent" )
+
+	def __init__( self, version="SIM-1.0", run_ms=2000, motor_current_ma=150, fragment=0, delay_ms=0, trace=None ):
+		self.version = version
+		self.run_ms = run_ms
+		self.motor_current_ma = motor_current_ma
+		self.fragment = fragment
+		self.delay_ms = delay_ms
+		self.trace = trace
+		self.relays = { VMC96Simulator._CONTROLLER_RELAY_1: 0, VMC96Simulator._CONTROLLER_RELAY_2: 0 }
+		self.running = {}
+		self.last_response = None
+		self.transactions = []
+		self.fault = None
+		self.master, self.slave = pty.openpty()
+		self.tty = os.ttyname( self.slave )
+
+	def _checksum( self, buf ):
+		chksum = 0
+		for byte in buf:
+			chksum ^= byte
+		return chksum
+
+	def _ack( self, cntrl, ack=0x00 ):
+		frame = [ VMC96Simulator._STX, cntrl, VMC96Simulator._MIN_LENGTH, ack ]
+		return frame + [ self._checksum( frame ) ]
+
+	def _data( self, cntrl, payload ):
+		frame = [ VMC96Simulator._STX, cntrl, len(payload) + 4 ] + payload
+		return frame + [ self._checksum( frame ) ]
+
+	def _valid_motor( self, mid ):
+		return ( 1 <= (mid >> 4) <= VMC96Simulator._ROWS ) and ( 1 <= (mid & 0x0F) <= VMC96Simulator._COLUMNS )
+
+	def _expire_motors( self ):
+		now = time.monotonic()
+		for mid in [ m for m, t in self.running.items() if t <= now ]:
+			del self.running[ mid ]
+
+	def _motor_response( self, cmd, args ):
+		cntrl = VMC96Simulator._CONTROLLER_MOTOR
+		self._expire_motors()
+		if( cmd in ( VMC96Simulator._COMMAND_SIMPLE_PING, ) ):
+			return self._ack( cntrl )
+		if( cmd == VMC96Simulator._COMMAND_RESET or cmd == VMC96Simulator._COMMAND_MOTOR_STOP_ALL ):
+			self.running = {}
+			return self._ack( cntrl )
+		if( cmd == VMC96Simulator._COMMAND_KERNEL_VERSION ):
+			return self._data( cntrl, [ cmd ] + list( self.version.encode() ) )
+		if( cmd == VMC96Simulator._COMMAND_MOTOR_RUN or cmd == VMC96Simulator._COMMAND_MOTOR_GIVE_PULSE ):
+			mids = args if cmd == VMC96Simulator._COMMAND_MOTOR_RUN else args[:1]
+			if( len(mids) == 0 or not all( self._valid_motor( m ) for m in mids ) ):
+				return self._ack( cntrl, 0x01 )
+			duration = self.run_ms if cmd == VMC96Simulator._COMMAND_MOTOR_RUN else args[1]
+			for mid in mids:
+				self.running[ mid ] = time.monotonic() + duration / 1000.0
+			return self._ack( cntrl )
+		if( cmd == VMC96Simulator._COMMAND_MOTOR_STATUS ):
+			current = min( len(self.running) * self.motor_current_ma, VMC96Simulator._MAX_CURRENT_READING_MA )
+			raw = ( current * 255 ) // VMC96Simulator._MAX_CURRENT_READING_MA
+			return self._data( cntrl, [ cmd, raw ] + sorted( self.running.keys() ) )
+		if( cmd == VMC96Simulator._COMMAND_MOTOR_OPTO_STATUS ):
+			# Product drop seen in the last sample of the block while a motor runs
+			return self._data( cntrl, [ cmd, 0x00, 0x00, 0x00, 0x80 if self.running else 0x00 ] )
+		if( cmd == VMC96Simulator._COMMAND_MOTOR_SCAN_ARRAY ):
+			return self._data( cntrl, [ cmd ] + [ 0xFF ] * VMC96Simulator._COLUMNS )
+		return self._ack( cntrl, 0x01 )
+
+	def _relay_response( self, cntrl, cmd, args ):
+		if( cmd == VMC96Simulator._COMMAND_SIMPLE_PING ):
+			return self._ack( cntrl )
+		if( cmd == VMC96Simulator._COMMAND_RESET ):
+			self.relays[ cntrl ] = 0
+			return self._ack( cntrl )
+		if( cmd == VMC96Simulator._COMMAND_KERNEL_VERSION ):
+			return self._data( cntrl, [ cmd ] + list( self.version.encode() ) )
+		if( cmd == VMC96Simulator._COMMAND_RELAY_FUNCTION and len(args) == 1 ):
+			self.relays[ cntrl ] = args[0]
+			return self._ack( cntrl )
+		return self._ack( cntrl, 0x01 )
+
+	def _inject( self, resp ):
+		fault, self.fault = self.fault, None
+		if( resp == None or fault == None ):
+			return resp
+		if( fault == "nak" ):
+			return self._ack( resp[1], 0x01 )
+		if( fault == "corrupt" ):
+			return resp[:-1] + [ resp[-1] ^ 0xFF ]
+		return None
+
+	def respond( self, req ):
+		cntrl, cmd, args = req[1], req[3], req[4:-1]
+		if( req[-1] != self._checksum( req[:-1] ) ):
+			return None
+		if( cntrl == VMC96Simulator._CONTROLLER_GLOBAL and cmd == VMC96Simulator._COMMAND_GLOBAL_RESET ):
+			self.running = {}
+			self.relays = { r: 0 for r in self.relays }
+			return self._ack( cntrl )
+		if( cntrl in self.relays ):
+			return self._relay_response( cntrl, cmd, args )
+		if( cntrl == VMC96Simulator._CONTROLLER_MOTOR ):
+			return self._motor_response( cmd, args )
+		return None
+
+	def _hex( self, frame ):
+		return " ".join( "{:02X}".format(b) for b in frame ) if frame else "(none)"
+
+	def _send( self, resp ):
+		if( self.delay_ms > 0 ):
+			time.sleep( self.delay_ms / 1000.0 )
+		chunk = self.fragment if self.fragment > 0 else len(resp)
+		for i in range( 0, len(resp), chunk ):
+			os.write( self.master, bytes( resp[i:i + chunk] ) )
+			if( i + chunk < len(resp) ):
+				time.sleep( 0.002 )
+
+	def serve( self, until=None ):
+		buf = []
+		while( until == None or until() ):
+			ready, _, _ = select.select( [ self.master ], [], [], 0.05 )
+			if( not ready ):
+				continue
+			try:
+				buf += list( os.read( self.master, 256 ) )
+			except OSError:
+				break
+			received = time.monotonic()
+			# Resynchronize on STX and handle every complete request
+			while( buf and buf[0] != VMC96Simulator._STX ):
+				buf.pop( 0 )
+			while( len(buf) >= 3 and buf[2] >= VMC96Simulator._MIN_LENGTH and len(buf) >= buf[2] ):
+				req, buf = buf[:buf[2]], buf[buf[2]:]
+				resp = self._inject( self.respond( req ) )
+				# Recorded before replying, so a client holding the reply sees its transaction
+				self.transactions.append( ( req, resp ) )
+				if( resp != None ):
+					self._send( resp )
+				if( self.trace ):
+					turnaround = "-" if self.last_response == None else "{:.3f}ms".format( (received - self.last_response) * 1000.0 )
+					self.trace.write( "{} -> {} [turnaround {}]\n".format( self._hex(req), self._hex(resp), turnaround ) )
+					self.trace.flush()
+				self.last_response = time.monotonic()
+
+
+def main():
+	parser = argparse.ArgumentParser( description="Simulated VMC96 board on a pseudo-terminal." )
+	parser.add_argument( "--version", default="SIM-1.0", help="kernel version string reported by every controller" )
+	parser.add_argument( "--run-ms", type=int, default=2000, help="how long a RUN keeps a motor active" )
+	parser.add_argument( "--motor-current-ma", type=int, default=150, help="current drained by each running motor" )
+	parser.add_argument( "--fragment", type=int, default=0, help="split responses in chunks of N bytes" )
+	parser.add_argument( "--delay-ms", type=int, default=0, help="delay before each response" )
+	parser.add_argument( "--trace", help="write a frame trace to this file ('-' for stdout)" )
+	parser.add_argument( "--boards", type=int, default=1, help="number of simulated boards, each on its own TTY" )
+	parser.add_argument( "client", nargs=argparse.REMAINDER, help="client command line ('{tty}' is replaced by the first TTY path, '{ttys}' by all of them)" )
+	args = parser.parse_args()
+
+	trace = None
+	if( args.trace == "-" ):
+		trace = sys.stdout
+	elif( args.trace ):
+		trace = open( args.trace, "w" )
+
+	sims = [ VMC96Simulator( args.version, args.run_ms, args.motor_current_ma, args.fragment, args.delay_ms, trace ) for _ in range( max( args.boards, 1 ) ) ]
+	ttys = [ sim.tty for sim in sims ]
+
+	client = []
+	for a in args.client:
+		if( a == "--" ):
+			continue
+		if( a == "{ttys}" ):
+			client += ttys
+		else:
+			client.append( a.replace( "{tty}", ttys[0] ) )
+
+	if( not client ):
+		print( "VMC96 simulator listening on: " + " ".join( ttys ) )
+		sys.stdout.flush()
+		until = lambda: True
+	else:
+		proc = subprocess.Popen( client )
+		until = lambda: proc.poll() == None
+
+	threads = [ threading.Thread( target=sim.serve, args=( until, ) ) for sim in sims[1:] ]
+	for thread in threads:
+		thread.daemon = True
+		thread.start()
+
+	try:
+		sims[0].serve( until )
+	except KeyboardInterrupt:
+		pass
+
+	if( not client ):
+		return 0
+
+	for thread in threads:
+		thread.join()
+
+	return proc.wait()
+
+if __name__ == "__main__":
+	sys.exit( main() )
+
+# end-of-file #
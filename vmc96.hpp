@@ -0,0 +1,647 @@
+/*!
+	\file vmc96.hpp
+	\brief C++20 Coroutine Awaitables and epoll Executor over the Non-Blocking VMC96 API
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#ifndef __VMC96_HPP__
+#define __VMC96_HPP__
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "vmc96api.h"
+
+
+namespace vmc96
+{
+	class Executor;
+	class Board;
+
+
+	/*!
+		\brief Result of an awaited command: VMC96 error code and decoded value.
+	*/
+	template< typename T >
+	struct Result
+	{
+		int error = VMC96_SUCCESS;    /*!< VMC96_SUCCESS or a VMC96_ERROR_* code */
+		T value {};                   /*!< Decoded response (valid on success) */
+
+		explicit operator bool() const { return error == VMC96_SUCCESS; }
+	};
+
+
+	/*!
+		\brief Value of commands answered by a plain acknowledgement.
+	*/
+	struct Ack {};
+
+
+	/*!
+		\brief Firmware version string.
+	*/
+	struct Version
+	{
+		char text[ VMC96_VERSION_STRING_MAX_LEN + 1 ];
+	};
+
+
+	/*!
+		\brief Fire-and-forget coroutine; it starts right away and is driven by Executor::run().
+	*/
+	struct Task
+	{
+		struct promise_type
+		{
+			Task get_return_object() { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+	};
+
+
+	namespace detail
+	{
+		/* One board transaction, owned by the awaiting coroutine frame */
+		struct Operation
+		{
+			std::function<int( VMC96_t* )> start;
+			std::coroutine_handle<> waiter;
+			int error = VMC96_SUCCESS;
+		};
+	}
+
+
+	/* ********************************************************************* */
+	/* *                             EXECUTOR                              * */
+	/* ********************************************************************* */
+
+	/*!
+		\brief Single-thread epoll executor.
+
+		Every board runs one K1 transaction at a time (further commands wait in a
+		per-board queue), and transactions complete on response arrival. Any number
+		of coroutines may await commands on any number of boards.
+	*/
+	class Executor
+	{
+	public:
+
+		/*! \brief Sleep awaitable returned by sleep_for(). */
+		class Sleep
+		{
+		public:
+			Sleep( Executor & executor, unsigned long ms ) : executor_( executor ), ms_( ms ) {}
+
+			bool await_ready() const noexcept { return ms_ == 0; }
+
+			void await_suspend( std::coroutine_handle<> h )
+			{
+				Executor & executor = executor_;
+				executor.schedule( vmc96_get_time_ms() + ms_, [ &executor, h ]() { executor.ready_.push_back( h ); } );
+			}
+
+			void await_resume() const noexcept {}
+
+		private:
+			Executor & executor_;
+			unsigned long ms_;
+		};
+
+		Executor()
+		{
+			epfd_ = epoll_create1( EPOLL_CLOEXEC );
+
+			if( epfd_ < 0 )
+				throw std::runtime_error( "vmc96: epoll_create1() failed" );
+		}
+
+		~Executor() { close( epfd_ ); }
+
+		Executor( const Executor & ) = delete;
+		Executor & operator=( const Executor & ) = delete;
+
+		/*! \brief Suspend the awaiting coroutine for ms milliseconds. */
+		Sleep sleep_for( unsigned long ms ) { return Sleep( *this, ms ); }
+
+		/*! \brief Drive coroutines until no transaction, queued command or timer is left. */
+		void run();
+
+	private:
+
+		friend class Board;
+		template< typename T > friend class Command;
+
+		/* libftdi boards have no descriptor and are polled this often */
+		static const int TICK_MS = 10;
+
+		void attach( Board * board );
+		void detach( Board * board );
+		bool submit( Board * board, detail::Operation * op );
+		void poll_board( Board * board );
+		void hang_up( Board * board );
+		void update_events( Board * board );
+		int wait_timeout_ms() const;
+
+		void schedule( unsigned long due_ms, std::function<void()> fn )
+		{
+			timers_.emplace( due_ms, std::move( fn ) );
+		}
+
+		int epfd_ = -1;
+		size_t pending_ = 0;
+		std::vector<Board*> boards_;
+		std::deque< std::coroutine_handle<> > ready_;
+		std::multimap< unsigned long, std::function<void()> > timers_;
+	};
+
+
+	/* ********************************************************************* */
+	/* *                          COMMAND AWAITABLE                        * */
+	/* ********************************************************************* */
+
+	/*!
+		\brief Awaitable board command; co_await yields a Result<T>.
+	*/
+	template< typename T >
+	class Command
+	{
+	public:
+		using Start = std::function<int( VMC96_t*, T* )>;
+
+		Command( Board & board, Start start, unsigned long not_before_ms = 0 ) :
+			board_( board ), start_( std::move( start ) ), not_before_ms_( not_before_ms ) {}
+
+		Command( const Command & ) = delete;
+		Command & operator=( const Command & ) = delete;
+
+		bool await_ready() const noexcept { return false; }
+
+		bool await_suspend( std::coroutine_handle<> h );
+
+		Result<T> await_resume() { return Result<T>{ op_.error, value_ }; }
+
+	private:
+		Board & board_;
+		Start start_;
+		unsigned long not_before_ms_;
+		detail::Operation op_;
+		T value_ {};
+	};
+
+
+	/* ********************************************************************* */
+	/* *                               BOARD                               * */
+	/* ********************************************************************* */
+
+	/*!
+		\brief VMC96 board driven in non-blocking mode by an Executor.
+
+		Command methods mirror the C API (without the vmc96_ prefix). A Board must
+		outlive every command awaited on it.
+	*/
+	class Board
+	{
+	public:
+
+		/*! \brief Open a serial TTY board (ftdi_sio); throws std::runtime_error on failure. */
+		Board( Executor & executor, const std::string & device ) : executor_( executor )
+		{
+			open( vmc96_initialize_tty( &vmc96_, device.c_str() ) );
+		}
+
+		/*! \brief Open the libftdi board (polled every Executor tick); throws std::runtime_error on failure. */
+		explicit Board( Executor & executor ) : executor_( executor )
+		{
+			open( vmc96_initialize( &vmc96_ ) );
+		}
+
+		~Board()
+		{
+			executor_.detach( this );
+			vmc96_finish( vmc96_ );
+		}
+
+		Board( const Board & ) = delete;
+		Board & operator=( const Board & ) = delete;
+
+		/*! \brief Underlying C context (e.g. for the run table and session accessors). */
+		VMC96_t * handle() const { return vmc96_; }
+
+		/*! \brief Enable/disable session mode (see vmc96_set_session()). */
+		void set_session( bool enable ) { vmc96_set_session( vmc96_, ( enable ) ? 1 : 0 ); }
+
+		/*! \brief True once the TTY hung up (e.g. USB unplug); every command then fails with VMC96_ERROR_TTY_READ_DATA. */
+		bool hung_up() const { return hung_up_; }
+
+		Command<Ack> global_reset() { return Command<Ack>( *this, []( VMC96_t * v, Ack * ) { return vmc96_global_reset( v ); } ); }
+
+		Command<Ack> relay_ping( unsigned char id ) { return Command<Ack>( *this, [id]( VMC96_t * v, Ack * ) { return vmc96_relay_ping( v, id ); } ); }
+
+		Command<Version> relay_get_version( unsigned char id ) { return Command<Version>( *this, [id]( VMC96_t * v, Version * r ) { return vmc96_relay_get_version( v, id, r->text ); } ); }
+
+		Command<Ack> relay_reset( unsigned char id ) { return Command<Ack>( *this, [id]( VMC96_t * v, Ack * ) { return vmc96_relay_reset( v, id ); } ); }
+
+		Command<Ack> relay_control( unsigned char id, unsigned char state ) { return Command<Ack>( *this, [id, state]( VMC96_t * v, Ack * ) { return vmc96_relay_control( v, id, state ); } ); }
+
+		Command<Ack> motor_ping() { return Command<Ack>( *this, []( VMC96_t * v, Ack * ) { return vmc96_motor_ping( v ); } ); }
+
+		Command<Version> motor_get_version() { return Command<Version>( *this, []( VMC96_t * v, Version * r ) { return vmc96_motor_get_version( v, r->text ); } ); }
+
+		Command<Ack> motor_reset() { return Command<Ack>( *this, []( VMC96_t * v, Ack * ) { return vmc96_motor_reset( v ); } ); }
+
+		Command<Ack> motor_prepare() { return Command<Ack>( *this, []( VMC96_t * v, Ack * ) { return vmc96_motor_prepare( v ); } ); }
+
+		Command<VMC96_motor_array_status_t> motor_get_status() { return Command<VMC96_motor_array_status_t>( *this, vmc96_motor_get_status ); }
+
+		Command<Ack> motor_stop_all() { return Command<Ack>( *this, []( VMC96_t * v, Ack * ) { return vmc96_motor_stop_all( v ); } ); }
+
+		Command<Ack> motor_run( unsigned char row, unsigned char col ) { return Command<Ack>( *this, [row, col]( VMC96_t * v, Ack * ) { return vmc96_motor_run( v, row, col ); } ); }
+
+		Command<Ack> motor_pair_run( unsigned char row, unsigned char col1, unsigned char col2 ) { return Command<Ack>( *this, [row, col1, col2]( VMC96_t * v, Ack * ) { return vmc96_motor_pair_run( v, row, col1, col2 ); } ); }
+
+		Command<VMC96_opto_line_sample_block_t> motor_opto_line_status() { return Command<VMC96_opto_line_sample_block_t>( *this, vmc96_motor_opto_line_status ); }
+
+		Command<VMC96_motor_array_scan_result_t> motor_scan_array() { return Command<VMC96_motor_array_scan_result_t>( *this, vmc96_motor_scan_array ); }
+
+		Command<Ack> motor_give_pulse( unsigned char row, unsigned char col, unsigned char duration_ms ) { return Command<Ack>( *this, [row, col, duration_ms]( VMC96_t * v, Ack * ) { return vmc96_motor_give_pulse( v, row, col, duration_ms ); } ); }
+
+	private:
+
+		friend class Executor;
+		template< typename T > friend class Command;
+		friend class OptoStream;
+
+		void open( int ret )
+		{
+			if( ret != VMC96_SUCCESS )
+				throw std::runtime_error( vmc96_get_error_code_string( ret ) );
+
+			vmc96_set_nonblocking( vmc96_, 1 );
+			fd_ = vmc96_get_fd( vmc96_ );
+			executor_.attach( this );
+		}
+
+		Executor & executor_;
+		VMC96_t * vmc96_ = nullptr;
+		int fd_ = -1;
+		uint32_t events_ = 0;
+		bool hung_up_ = false;
+		detail::Operation * inflight_ = nullptr;
+		std::deque< detail::Operation* > queue_;
+	};
+
+
+	/*!
+		\brief Stream of opto line sample blocks.
+
+		Each co_await next() yields the following block, requested no earlier than
+		one block length (VMC96_OPTO_LINE_SAMPLE_BLOCK_LENGTH_MS) after the previous
+		one arrived, so consecutive results never overlap in time.
+	*/
+	class OptoStream
+	{
+	public:
+
+		/*! \brief Awaitable returned by next(). */
+		class Next
+		{
+		public:
+			Next( OptoStream & stream, unsigned long not_before_ms ) :
+				stream_( stream ), command_( stream.board_, vmc96_motor_opto_line_status, not_before_ms ) {}
+
+			bool await_ready() const noexcept { return false; }
+
+			bool await_suspend( std::coroutine_handle<> h ) { return command_.await_suspend( h ); }
+
+			Result<VMC96_opto_line_sample_block_t> await_resume()
+			{
+				stream_.started_ = true;
+				stream_.last_ms_ = vmc96_get_time_ms();
+
+				return command_.await_resume();
+			}
+
+		private:
+			OptoStream & stream_;
+			Command<VMC96_opto_line_sample_block_t> command_;
+		};
+
+		explicit OptoStream( Board & board ) : board_( board ) {}
+
+		Next next()
+		{
+			return Next( *this, ( started_ ) ? last_ms_ + VMC96_OPTO_LINE_SAMPLE_BLOCK_LENGTH_MS : 0 );
+		}
+
+	private:
+		Board & board_;
+		bool started_ = false;
+		unsigned long last_ms_ = 0;
+	};
+
+
+	/* ********************************************************************* */
+	/* *                          IMPLEMENTATION                           * */
+	/* ********************************************************************* */
+
+	template< typename T >
+	bool Command<T>::await_suspend( std::coroutine_handle<> h )
+	{
+		Executor & executor = board_.executor_;
+
+		op_.waiter = h;
+		op_.start = [this]( VMC96_t * v ) { return start_( v, &value_ ); };
+
+		if( (not_before_ms_ != 0) && ((long) (not_before_ms_ - vmc96_get_time_ms()) > 0) )
+		{
+			executor.schedule( not_before_ms_, [this, &executor]()
+			{
+				if( !executor.submit( &board_, &op_ ) )
+					executor.ready_.push_back( op_.waiter );
+			} );
+
+			return true;
+		}
+
+		/* Commands rejected before reaching the board complete without suspending */
+		return executor.submit( &board_, &op_ );
+	}
+
+
+	inline void Executor::attach( Board * board )
+	{
+		struct epoll_event ev = {};
+
+		boards_.push_back( board );
+
+		if( board->fd_ < 0 )
+			return;
+
+		ev.events = 0;
+		ev.data.ptr = board;
+
+		if( epoll_ctl( epfd_, EPOLL_CTL_ADD, board->fd_, &ev ) < 0 )
+			throw std::runtime_error( "vmc96: epoll_ctl() failed" );
+	}
+
+
+	inline void Executor::detach( Board * board )
+	{
+		if( (board->fd_ >= 0) && !board->hung_up_ )
+			epoll_ctl( epfd_, EPOLL_CTL_DEL, board->fd_, nullptr );
+
+		for( size_t i = 0; i < boards_.size(); i++ )
+		{
+			if( boards_[i] == board )
+			{
+				boards_.erase( boards_.begin() + i );
+				break;
+			}
+		}
+	}
+
+
+	inline bool Executor::submit( Board * board, detail::Operation * op )
+	{
+		int ret = 0;
+
+		if( board->hung_up_ )
+		{
+			op->error = VMC96_ERROR_TTY_READ_DATA;
+			return false;
+		}
+
+		if( board->inflight_ || !board->queue_.empty() )
+		{
+			board->queue_.push_back( op );
+			pending_++;
+			return true;
+		}
+
+		ret = op->start( board->vmc96_ );
+
+		if( ret != VMC96_ERROR_K1_RESPONSE_PENDING )
+		{
+			op->error = ret;
+			return false;
+		}
+
+		board->inflight_ = op;
+		pending_++;
+		update_events( board );
+
+		return true;
+	}
+
+
+	inline void Executor::poll_board( Board * board )
+	{
+		detail::Operation * op = nullptr;
+		int ret = 0;
+
+		while( board->inflight_ )
+		{
+			ret = vmc96_poll( board->vmc96_ );
+
+			if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+				break;
+
+			op = board->inflight_;
+			op->error = ret;
+			board->inflight_ = nullptr;
+			pending_--;
+			ready_.push_back( op->waiter );
+
+			/* Start the next queued command (those failing locally complete at once) */
+			while( !board->inflight_ && !board->queue_.empty() )
+			{
+				op = board->queue_.front();
+				board->queue_.pop_front();
+
+				ret = op->start( board->vmc96_ );
+
+				if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+				{
+					board->inflight_ = op;
+					break;
+				}
+
+				op->error = ret;
+				pending_--;
+				ready_.push_back( op->waiter );
+			}
+		}
+
+		update_events( board );
+	}
+
+
+	inline void Executor::hang_up( Board * board )
+	{
+		detail::Operation * op = nullptr;
+
+		/* epoll reports a hung up descriptor forever, whatever events are requested */
+		epoll_ctl( epfd_, EPOLL_CTL_DEL, board->fd_, nullptr );
+		board->hung_up_ = true;
+		board->events_ = 0;
+
+		while( !board->queue_.empty() )
+		{
+			op = board->queue_.front();
+			board->queue_.pop_front();
+
+			op->error = VMC96_ERROR_TTY_READ_DATA;
+			pending_--;
+			ready_.push_back( op->waiter );
+		}
+
+		/* Collect what already arrived; otherwise the in-flight transaction ends at its deadline */
+		poll_board( board );
+	}
+
+
+	inline void Executor::update_events( Board * board )
+	{
+		struct epoll_event ev = {};
+		uint32_t events = 0;
+
+		if( (board->fd_ < 0) || board->hung_up_ )
+			return;
+
+		if( board->inflight_ )
+			events = ( vmc96_write_pending( board->vmc96_ ) ) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+
+		if( events == board->events_ )
+			return;
+
+		ev.events = events;
+		ev.data.ptr = board;
+
+		epoll_ctl( epfd_, EPOLL_CTL_MOD, board->fd_, &ev );
+		board->events_ = events;
+	}
+
+
+	inline int Executor::wait_timeout_ms() const
+	{
+		unsigned long now = vmc96_get_time_ms();
+		bool found = false;
+		long timeout = 0;
+		long wait = 0;
+		size_t i = 0;
+
+		for( i = 0; i < boards_.size(); i++ )
+		{
+			if( !boards_[i]->inflight_ )
+				continue;
+
+			/* libftdi boards have no descriptor: poll them every tick */
+			wait = ( boards_[i]->fd_ < 0 ) ? TICK_MS : (long) (vmc96_get_deadline_ms( boards_[i]->vmc96_ ) - now);
+
+			if( !found || (wait < timeout) )
+				timeout = wait;
+
+			found = true;
+		}
+
+		if( !timers_.empty() )
+		{
+			wait = (long) (timers_.begin()->first - now);
+
+			if( !found || (wait < timeout) )
+				timeout = wait;
+
+			found = true;
+		}
+
+		if( !found )
+			return -1;
+
+		return ( timeout < 0 ) ? 0 : (int) timeout;
+	}
+
+
+	inline void Executor::run()
+	{
+		struct epoll_event events[ 64 ];
+		std::coroutine_handle<> h;
+		unsigned long now = 0;
+		int n = 0;
+		int i = 0;
+
+		while( true )
+		{
+			while( !ready_.empty() )
+			{
+				h = ready_.front();
+				ready_.pop_front();
+				h.resume();
+			}
+
+			if( (pending_ == 0) && timers_.empty() )
+				break;
+
+			n = epoll_wait( epfd_, events, 64, wait_timeout_ms() );
+
+			for( i = 0; i < n; i++ )
+			{
+				if( events[i].events & (EPOLLHUP | EPOLLERR) )
+					hang_up( (Board*) events[i].data.ptr );
+				else
+					poll_board( (Board*) events[i].data.ptr );
+			}
+
+			now = vmc96_get_time_ms();
+
+			/* Deadlines expire whatever other boards are doing (libftdi boards are polled every tick) */
+			for( i = 0; i < (int) boards_.size(); i++ )
+				if( boards_[i]->inflight_ && ((boards_[i]->fd_ < 0) || ((long) (now - vmc96_get_deadline_ms( boards_[i]->vmc96_ )) >= 0)) )
+					poll_board( boards_[i] );
+
+			while( !timers_.empty() && ((long) (timers_.begin()->first - now) <= 0) )
+			{
+				std::function<void()> fn = std::move( timers_.begin()->second );
+				timers_.erase( timers_.begin() );
+				fn();
+			}
+		}
+	}
+}
+
+#endif
+
+/* eof */
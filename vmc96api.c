@@ -28,9 +28,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef __linux__
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
 #elif _WIN32
 #include <windows.h>
 #else
@@ -40,6 +45,7 @@
 #include <libftdi1/ftdi.h>
 
 #include "vmc96api.h"
+#include "vmc96k1.h"
 
 
 /* ********************************************************************* */
@@ -51,54 +57,17 @@
 #define VMC96_DEVICE_PRODUCT_ID                           (0x0023)
 #define VMC96_DEVICE_BAUDRATE                             (19200)
 
-/* K1 PROTOCOL SPECIFICS */
-#define VMC96_K1_MESSAGE_STX                              (0x35)
-#define VMC96_K1_MESSAGE_MAX_LEN                          (255)
-#define VMC96_K1_MESSAGE_MIN_LEN                          (5)
-#define VMC96_K1_MESSAGE_DATA_MAX_LEN                     (250)
-#define VMC96_K1_RESPONSE_POSITIVE_ACK                    (0x00)
-
-/* K1 PROTOCOL REPONSE TYPES */
-#define VMC96_K1_RESPONSE_TYPE_INVALID                    (-1)
-#define VMC96_K1_RESPONSE_TYPE_ACK                        (1)
-#define VMC96_K1_RESPONSE_TYPE_DATA                       (2)
+/* K1 PROTOCOL TIMING */
 #define VMC96_K1_RESPONSE_TIMEOUT_MS                      (1000)
 #define VMC96_K1_RESPONSE_READ_RETRY_DELAY_MS             (10)
 
-/* DEVICE */
-#define VMC96_MOTOR_MAX_CURRENT_READING_MA                (500)
-
-/* VMC96 AVAILABLE CONTROLLERS */
-#define VMC96_CONTROLLER_GLOBAL_BROADCAST                 (0x00)
-#define VMC96_CONTROLLER_RELAY_BASE_ADDRESS               (0x26)
-#define VMC96_CONTROLLER_RELAY_1                          (0x26)
-#define VMC96_CONTROLLER_RELAY_2                          (0x27)
-#define VMC96_CONTROLLER_MOTOR_ARRAY                      (0x30)
-
-/* VMC96 GLOBAL COMMANDS */
-#define VMC96_COMMAND_SIMPLE_PING                         (0x00)
-#define VMC96_COMMAND_GLOBAL_RESET                        (0x01)
-#define VMC96_COMMAND_KERNEL_VERSION                      (0x02)
-#define VMC96_COMMAND_RESET                               (0x05)
-
-/* VMC96 MOTOR ARRAY COMMANDS */
-#define VMC96_COMMAND_MOTOR_RESET                         (0x05)
-#define VMC96_COMMAND_MOTOR_STATUS_REQUEST                (0x10)
-#define VMC96_COMMAND_MOTOR_SCAN_ARRAY                    (0x11)
-#define VMC96_COMMAND_MOTOR_STOP_ALL                      (0x12)
-#define VMC96_COMMAND_MOTOR_RUN                           (0x13)
-#define VMC96_COMMAND_MOTOR_GIVE_PULSE                    (0x14)
-#define VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS              (0x15)
-
-/* VMC96 GENERAL PURPOSE RELAYS COMMANDS */
-#define VMC96_COMMAND_RELAY_FUNCTION                      (0x11)
-
-/* HELPERS */
-#define VMC96_GET_MOTOR_ID( _row, _col )                  (((_row + 1) << 4) + (_col + 1))
-#define VMC96_GET_MOTOR_ROW( _mid )                       ( ( (_mid & 0xF0) >> 4 ) - 1 )
-#define VMC96_GET_MOTOR_COL( _mid )                       ( ( _mid & 0x0F ) - 1 )
-#define VMC96_GET_MOTOR_CURRENT_MA( _val )                (( VMC96_MOTOR_MAX_CURRENT_READING_MA * _val) / 255 )
-#define VMC96_VALIDATE_MOTOR_COORDINATE( _row, _col )     ((_row < VMC96_MOTOR_ARRAY_ROWS_COUNT) && (_col < VMC96_MOTOR_ARRAY_COLUMNS_COUNT))
+/* MOTOR ARRAY PREPARATION STEPS */
+#define VMC96_PREPARE_STEP_NONE                           (0)
+#define VMC96_PREPARE_STEP_START                          (1)
+#define VMC96_PREPARE_STEP_PROBE                          (2)
+#define VMC96_PREPARE_STEP_STOP                           (3)
+#define VMC96_PREPARE_STEP_RESET                          (4)
+#define VMC96_PREPARE_STEP_VERSION                        (5)
 
 /* SLEEP/DELAY */
 #ifdef __linux__
@@ -125,17 +94,28 @@
 /* *                        STRUCTS AND DATA TYPES                     * */
 /* ********************************************************************* */
 
-typedef struct vmc96_message_s vmc96_message_t;
+typedef struct vmc96_transaction_s vmc96_transaction_t;
 
+typedef struct vmc96_prepare_s vmc96_prepare_t;
 
-struct vmc96_message_s
+typedef int (*vmc96_decoder_t)( VMC96_t * vmc96, void * result );
+
+
+struct vmc96_transaction_s
 {
-	unsigned char id_controller;
-	unsigned char command;
-	unsigned char data[ VMC96_K1_MESSAGE_DATA_MAX_LEN ];
-	unsigned char data_length;
-	unsigned char k1[ VMC96_K1_MESSAGE_MAX_LEN ];
-	unsigned char k1_length;
+	int pending;
+	unsigned long deadline_ms;
+	size_t sent;
+	vmc96_decoder_t decoder;
+	void * result;
+};
+
+
+struct vmc96_prepare_s
+{
+	int step;
+	VMC96_motor_array_status_t status;
+	char version[ VMC96_VERSION_STRING_MAX_LEN + 1 ];
 };
 
 
@@ -143,8 +123,16 @@ struct VMC96_s
 {
 	struct ftdi_context * ftdi;
 	struct ftdi_version_info ftdi_version;
+	int fd;
 	vmc96_message_t message;
 	vmc96_message_t response;
+	vmc96_transaction_t transaction;
+	int nonblocking;
+	int external_io;
+	VMC96_motor_run_table_t run_table;
+	VMC96_motor_run_delta_t run_delta;
+	VMC96_session_t session;
+	vmc96_prepare_t prepare;
 };
 
 
@@ -163,41 +151,64 @@ struct VMC96_s
 static void vmc96_dump_buffer( FILE * fp, const char * desc, unsigned char * buf, size_t len );
 
 /*!
-	\brief Calculate K1 Message Checksum
+	\brief Update Running Motors Table from a Status Response
 	\param vmc96
-	\param buf
-	\param buflen
+	\param status
 	\return
 */
-static unsigned char vmc96_calculate_checksum( unsigned char * buf, size_t buflen );
+static void vmc96_update_run_table( VMC96_t * vmc96, const VMC96_motor_array_status_t * status );
 
 /*!
-	\brief Send K1 Message
+	\brief Mark every Motor Stopped after an Acknowledged Stop/Reset
 	\param vmc96
 	\return
 */
-static int vmc96_send_k1_message( VMC96_t * vmc96 );
+static void vmc96_clear_run_table( VMC96_t * vmc96 );
+
+/*!
+	\brief Update Motor Array Controller Session State from a Completed Transaction
+	\param vmc96
+	\param ret
+	\return
+*/
+static void vmc96_update_session( VMC96_t * vmc96, int ret );
 
 /*!
-	\brief Prepare K1 Message to send
+	\brief Send the Next Request of vmc96_motor_prepare() from the Result of the Previous One
 	\param vmc96
+	\param ret
 	\return
 */
-static int vmc96_prepare_k1_message( VMC96_t * vmc96 );
+static int vmc96_prepare_advance( VMC96_t * vmc96, int ret );
 
 /*!
-	\brief Parse K1 Message Response
+	\brief Finish the Pending Transaction (parse, decode, session and prepare updates)
 	\param vmc96
+	\param ret
 	\return
 */
-static int vmc96_parse_k1_response( VMC96_t * vmc96 );
+static int vmc96_complete_transaction( VMC96_t * vmc96, int ret );
 
 /*!
-	\brief Parse K1 Message Response Type
+	\brief Send K1 Message
+	\param vmc96
+	\return
+*/
+static int vmc96_send_k1_message( VMC96_t * vmc96 );
+
+/*!
+	\brief Wait for K1 Response bytes (or a retry delay without a TTY)
 	\param vmc96
 	\return
 */
-static int vmc96_k1_parse_response_type( VMC96_t * vmc96 );
+static void vmc96_wait_k1_response( VMC96_t * vmc96 );
+
+/*!
+	\brief Receive available K1 Response bytes
+	\param vmc96
+	\return
+*/
+static int vmc96_receive_k1_response( VMC96_t * vmc96 );
 
 /*!
 	\brief Send Message
@@ -213,6 +224,38 @@ static int vmc96_send_message( VMC96_t * vmc96, unsigned char id_cntlr, unsigned
 */
 static int vmc96_send_message_ex( VMC96_t * vmc96, unsigned char id_cntlr, unsigned char cmd, unsigned char * data, unsigned char datalen );
 
+/*!
+	\brief Send Request without waiting for its response
+	\param vmc96
+	\return
+*/
+static int vmc96_start_request( VMC96_t * vmc96, unsigned char id_cntlr, unsigned char cmd, unsigned char * data, unsigned char datalen, vmc96_decoder_t decoder, void * result );
+
+/*!
+	\brief Wait for the Pending Transaction (non-blocking contexts leave it to vmc96_poll())
+	\param vmc96
+	\return
+*/
+static int vmc96_complete_request( VMC96_t * vmc96 );
+
+/*!
+	\brief Send Request and decode its response into result
+	\param vmc96
+	\return
+*/
+static int vmc96_send_request( VMC96_t * vmc96, unsigned char id_cntlr, unsigned char cmd, unsigned char * data, unsigned char datalen, vmc96_decoder_t decoder, void * result );
+
+/*!
+	\brief Response Decoders
+	\param vmc96
+	\param result
+	\return
+*/
+static int vmc96_decode_version( VMC96_t * vmc96, void * result );
+static int vmc96_decode_motor_status( VMC96_t * vmc96, void * result );
+static int vmc96_decode_opto_line_status( VMC96_t * vmc96, void * result );
+static int vmc96_decode_scan_array( VMC96_t * vmc96, void * result );
+
 
 /* ********************************************************************* */
 /* *                             DEBUG                                 * */
@@ -257,7 +300,23 @@ const char * vmc96_get_error_code_string( int cod )
 		case VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE   : return "Invalid response source."; break;
 		case VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH   : return "Invalid response length."; break;
 		case VMC96_ERROR_K1_RESPONSE_TIMEOUT          : return "Device took too long to respond (timeout)."; break;
+		case VMC96_ERROR_K1_RESPONSE_PENDING          : return "Response pending (non-blocking transaction in progress)."; break;
+		case VMC96_ERROR_K1_TRANSACTION_BUSY          : return "Another transaction is still pending."; break;
 		case VMC96_ERROR_INVALID_MOTOR_COORDINATES    : return "Invalid motor coordinates."; break;
+		case VMC96_ERROR_TTY_OPEN_DEVICE              : return "Can not open TTY device (not found, permission denied or not supported)."; break;
+		case VMC96_ERROR_TTY_SET_ATTRIBUTES           : return "Can not set TTY line attributes."; break;
+		case VMC96_ERROR_TTY_WRITE_DATA               : return "Can not write data to TTY device."; break;
+		case VMC96_ERROR_TTY_READ_DATA                : return "Can not read data from TTY device."; break;
+		case VMC96_ERROR_TTY_FLUSH_BUFFERS            : return "Can not flush TTY RX/TX buffers."; break;
+		case VMC96_ERROR_BUDGET_TOO_MANY_BOARDS       : return "Too many boards attached to the current budget."; break;
+		case VMC96_ERROR_BUDGET_UNKNOWN_BOARD         : return "Board not attached to the current budget."; break;
+		case VMC96_ERROR_BUDGET_QUEUE_FULL            : return "Current budget run queue is full."; break;
+		case VMC96_ERROR_BUDGET_EXCEEDS_LIMIT         : return "Motor run can never fit in the current budget."; break;
+		case VMC96_ERROR_BUDGET_RUN_QUEUED            : return "Motor run queued until current budget is available."; break;
+		case VMC96_ERROR_URING_SETUP                  : return "Can not set up io_uring instance."; break;
+		case VMC96_ERROR_URING_TOO_MANY_BOARDS        : return "Too many boards attached to the io_uring transport."; break;
+		case VMC96_ERROR_URING_UNKNOWN_BOARD          : return "Board not attached to the io_uring transport."; break;
+		case VMC96_ERROR_URING_SUBMIT                 : return "Can not submit requests to io_uring."; break;
 		default                                       : return "Unknown error."; break;
 
 	}
@@ -276,22 +335,9 @@ int vmc96_relay_ping( VMC96_t * vmc96, unsigned char id )
 
 int vmc96_relay_get_version( VMC96_t * vmc96, unsigned char id, char * version )
 {
-	int ret = 0;
-
 	*version = '\0';
 
-	ret = vmc96_send_message( vmc96, VMC96_CONTROLLER_RELAY_BASE_ADDRESS + id, VMC96_COMMAND_KERNEL_VERSION );
-
-	if( ret != VMC96_SUCCESS )
-		return ret;
-
-	if( vmc96->response.data_length > 0 )
-	{
-		memcpy( version, vmc96->response.data + 1, vmc96->response.data_length - 1 );
-		version[ vmc96->response.data_length - 1 ] = '\0';
-	}
-
-	return VMC96_SUCCESS;
+	return vmc96_send_request( vmc96, VMC96_CONTROLLER_RELAY_BASE_ADDRESS + id, VMC96_COMMAND_KERNEL_VERSION, NULL, 0, vmc96_decode_version, version );
 }
 
 
@@ -320,22 +366,9 @@ int vmc96_motor_ping( VMC96_t * vmc96 )
 
 int vmc96_motor_get_version( VMC96_t * vmc96, char * version )
 {
-	int ret = 0;
-
 	*version = '\0';
 
-	ret = vmc96_send_message( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_KERNEL_VERSION );
-
-	if( ret != VMC96_SUCCESS )
-		return ret;
-
-	if( vmc96->response.data_length > 0 )
-	{
-		memcpy( version, vmc96->response.data + 1, vmc96->response.data_length - 1 );
-		version[ vmc96->response.data_length - 1 ] = '\0';
-	}
-
-	return VMC96_SUCCESS;
+	return vmc96_send_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_KERNEL_VERSION, NULL, 0, vmc96_decode_version, version );
 }
 
 
@@ -347,40 +380,11 @@ int vmc96_motor_reset( VMC96_t * vmc96 )
 
 int vmc96_motor_get_status( VMC96_t * vmc96, VMC96_motor_array_status_t * status )
 {
-	int ret = 0;
-	int i = 0;
-
 	memset( status, 0, sizeof(VMC96_motor_array_status_t) );
 
-	ret = vmc96_send_message( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST );
-
-	if( ret != VMC96_SUCCESS )
-		return ret;
-
-	if( vmc96->response.data_length >= 2 )
-	{
-		if( vmc96->response.data[0] != VMC96_COMMAND_MOTOR_STATUS_REQUEST )
-			return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
-
-		status->current_ma = VMC96_GET_MOTOR_CURRENT_MA( vmc96->response.data[1] );
-
-		status->active_count = vmc96->response.data_length - 2;
-
-		memset( &status->array, 0, sizeof(VMC96_motor_array_t) );
-
-		for( i = 0; i < vmc96->response.data_length - 2; i++ )
-		{
-			unsigned char row = VMC96_GET_MOTOR_ROW( vmc96->response.data[ i + 2 ] );
-			unsigned char col = VMC96_GET_MOTOR_COL( vmc96->response.data[ i + 2 ] );
-
-			status->array.motor[ row ][ col ] = 1;
-		}
-	}
-
-	return VMC96_SUCCESS;
+	return vmc96_send_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST, NULL, 0, vmc96_decode_motor_status, status );
 }
 
-
 int vmc96_motor_stop_all( VMC96_t * vmc96 )
 {
 	return vmc96_send_message( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STOP_ALL );
@@ -411,69 +415,282 @@ int vmc96_motor_pair_run( VMC96_t * vmc96, unsigned char row, unsigned char col1
 
 int vmc96_motor_opto_line_status( VMC96_t * vmc96, VMC96_opto_line_sample_block_t * status_block )
 {
-	int ret = 0;
-	int i = 0;
-	int j = 0;
-	int k = 0;
-
 	memset( status_block, 0, sizeof(VMC96_opto_line_sample_block_t) );
 
-	ret = vmc96_send_message( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS );
+	return vmc96_send_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS, NULL, 0, vmc96_decode_opto_line_status, status_block );
+}
 
-	if( ret != VMC96_SUCCESS )
-		return ret;
 
-	for( i = 0; i < 4; i++ )
+int vmc96_motor_scan_array( VMC96_t * vmc96, VMC96_motor_array_scan_result_t * result )
+{
+	memset( result, 0, sizeof(VMC96_motor_array_scan_result_t) );
+
+	return vmc96_send_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_SCAN_ARRAY, NULL, 0, vmc96_decode_scan_array, result );
+}
+
+
+int vmc96_motor_give_pulse( VMC96_t * vmc96, unsigned char row, unsigned char col, unsigned char duration_ms )
+{
+	unsigned char data[2] = { VMC96_GET_MOTOR_ID( row, col ), duration_ms };
+
+	if( !VMC96_VALIDATE_MOTOR_COORDINATE( row, col) )
+		return VMC96_ERROR_INVALID_MOTOR_COORDINATES;
+
+	return vmc96_send_message_ex( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_GIVE_PULSE, data, 2 );
+}
+
+
+/* ********************************************************************* */
+/* *                       RUNNING MOTORS TABLE                        * */
+/* ********************************************************************* */
+
+static void vmc96_update_run_table( VMC96_t * vmc96, const VMC96_motor_array_status_t * status )
+{
+	unsigned long now = vmc96_get_time_ms();
+	unsigned char row = 0;
+	unsigned char col = 0;
+
+	for( row = 0; row < VMC96_MOTOR_ARRAY_ROWS_COUNT; row++ )
 	{
-		for( j = 0; j < 8; j++ )
+		for( col = 0; col < VMC96_MOTOR_ARRAY_COLUMNS_COUNT; col++ )
 		{
-			status_block->sample[ k++ ] = (vmc96->response.data[ i + 1 ] >> j) & 0x01;
+			VMC96_motor_run_info_t * info = &vmc96->run_table.motor[ row ][ col ];
+
+			if( status->array.motor[ row ][ col ] )
+			{
+				if( !info->running )
+				{
+					info->running = 1;
+					info->first_seen_ms = now;
+
+					if( !vmc96->run_delta.started.motor[ row ][ col ] )
+					{
+						vmc96->run_delta.started.motor[ row ][ col ] = 1;
+						vmc96->run_delta.started_count++;
+					}
+				}
+
+				info->last_seen_ms = now;
+			}
+			else if( info->running )
+			{
+				info->running = 0;
+
+				if( !vmc96->run_delta.stopped.motor[ row ][ col ] )
+				{
+					vmc96->run_delta.stopped.motor[ row ][ col ] = 1;
+					vmc96->run_delta.stopped_count++;
+				}
+			}
 		}
 	}
 
+	vmc96->run_table.running_count = status->active_count;
+	vmc96->run_table.current_ma = status->current_ma;
+	vmc96->run_table.updated_ms = now;
+}
+
+
+static void vmc96_clear_run_table( VMC96_t * vmc96 )
+{
+	VMC96_motor_array_status_t status;
+
+	/* Same bookkeeping as a status reply with no active motors */
+	memset( &status, 0, sizeof(VMC96_motor_array_status_t) );
+
+	vmc96_update_run_table( vmc96, &status );
+}
+
+
+int vmc96_motor_get_run_table( VMC96_t * vmc96, VMC96_motor_run_table_t * table )
+{
+	memcpy( table, &vmc96->run_table, sizeof(VMC96_motor_run_table_t) );
+
 	return VMC96_SUCCESS;
 }
 
 
-int vmc96_motor_scan_array( VMC96_t * vmc96, VMC96_motor_array_scan_result_t * result )
+int vmc96_motor_get_run_delta( VMC96_t * vmc96, VMC96_motor_run_delta_t * delta )
 {
-	int ret = 0;
-	unsigned char row = 0;
-	unsigned char col = 0;
+	memcpy( delta, &vmc96->run_delta, sizeof(VMC96_motor_run_delta_t) );
+	memset( &vmc96->run_delta, 0, sizeof(VMC96_motor_run_delta_t) );
+
+	return VMC96_SUCCESS;
+}
+
+
+unsigned long vmc96_motor_get_run_duration_ms( VMC96_t * vmc96, unsigned char row, unsigned char col )
+{
+	const VMC96_motor_run_info_t * info = NULL;
+
+	if( !VMC96_VALIDATE_MOTOR_COORDINATE( row, col ) )
+		return 0;
+
+	info = &vmc96->run_table.motor[ row ][ col ];
+
+	if( info->running )
+		return vmc96_get_time_ms() - info->first_seen_ms;
+
+	return info->last_seen_ms - info->first_seen_ms;
+}
 
-	ret = vmc96_send_message( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_SCAN_ARRAY );
 
+/* ********************************************************************* */
+/* *                     MOTOR ARRAY SESSION STATE                     * */
+/* ********************************************************************* */
+
+static void vmc96_update_session( VMC96_t * vmc96, int ret )
+{
+	VMC96_session_t * session = &vmc96->session;
+	unsigned char id_cntlr = vmc96->message.id_controller;
+
+	if( (id_cntlr != VMC96_CONTROLLER_MOTOR_ARRAY) && (id_cntlr != VMC96_CONTROLLER_GLOBAL_BROADCAST) )
+		return;
+
+	/* Any failure leaves the controller in an unknown state */
 	if( ret != VMC96_SUCCESS )
-		return ret;
+	{
+		session->state = VMC96_SESSION_STATE_UNKNOWN;
+		return;
+	}
 
-	if( vmc96->response.data[0] != VMC96_COMMAND_MOTOR_SCAN_ARRAY )
-		return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
+	session->last_success_ms = vmc96_get_time_ms();
 
-	memset( &result->array, 0, sizeof(VMC96_motor_array_scan_result_t) );
+	switch( vmc96->message.command )
+	{
+		case VMC96_COMMAND_RESET:
+		case VMC96_COMMAND_GLOBAL_RESET:
+		case VMC96_COMMAND_MOTOR_STOP_ALL:
+			vmc96_clear_run_table( vmc96 );
+			session->state = VMC96_SESSION_STATE_IDLE;
+			break;
+
+		case VMC96_COMMAND_MOTOR_RUN:
+		case VMC96_COMMAND_MOTOR_GIVE_PULSE:
+			session->state = VMC96_SESSION_STATE_BUSY;
+			break;
+
+		case VMC96_COMMAND_MOTOR_STATUS_REQUEST:
+			session->state = ( vmc96->run_table.running_count ) ? VMC96_SESSION_STATE_BUSY : VMC96_SESSION_STATE_IDLE;
+			break;
+
+		case VMC96_COMMAND_KERNEL_VERSION:
+			strncpy( session->version, (const char*) vmc96->transaction.result, VMC96_VERSION_STRING_MAX_LEN );
+			session->version[ VMC96_VERSION_STRING_MAX_LEN ] = '\0';
+			break;
 
-	for( row = 0; row < VMC96_MOTOR_ARRAY_ROWS_COUNT; row++ )
+		default:
+			break;
+	}
+}
+
+
+int vmc96_set_session( VMC96_t * vmc96, int enable )
+{
+	vmc96->session.enabled = ( enable ) ? 1 : 0;
+
+	return VMC96_SUCCESS;
+}
+
+
+static int vmc96_prepare_advance( VMC96_t * vmc96, int ret )
+{
+	VMC96_session_t * session = &vmc96->session;
+	vmc96_prepare_t * prepare = &vmc96->prepare;
+
+	while( 1 )
 	{
-		for( col = 0; col < VMC96_MOTOR_ARRAY_COLUMNS_COUNT; col++ )
+		switch( prepare->step )
 		{
-			result->array.motor[ row ][ col ] = ( vmc96->response.data[ 1 + col ] >> row ) & 0x1;
+			case VMC96_PREPARE_STEP_START:
+				if( !session->enabled || (session->state == VMC96_SESSION_STATE_UNKNOWN) )
+					prepare->step = VMC96_PREPARE_STEP_RESET;
+				else if( (session->state == VMC96_SESSION_STATE_BUSY) || (vmc96_get_time_ms() - session->last_success_ms >= VMC96_SESSION_STALE_MS) )
+					prepare->step = VMC96_PREPARE_STEP_PROBE;  /* Busy or silent for too long */
+				else
+					prepare->step = VMC96_PREPARE_STEP_VERSION;
+				break;
+
+			case VMC96_PREPARE_STEP_PROBE:
+				if( ret != VMC96_SUCCESS )
+					prepare->step = VMC96_PREPARE_STEP_RESET;
+				else if( session->state == VMC96_SESSION_STATE_BUSY )
+					prepare->step = VMC96_PREPARE_STEP_STOP;
+				else
+					prepare->step = VMC96_PREPARE_STEP_VERSION;
+				break;
+
+			case VMC96_PREPARE_STEP_STOP:
+				prepare->step = ( ret == VMC96_SUCCESS ) ? VMC96_PREPARE_STEP_VERSION : VMC96_PREPARE_STEP_RESET;
+				break;
+
+			case VMC96_PREPARE_STEP_RESET:
+				prepare->step = ( (ret == VMC96_SUCCESS) && session->enabled ) ? VMC96_PREPARE_STEP_VERSION : VMC96_PREPARE_STEP_NONE;
+				break;
+
+			default:
+				prepare->step = VMC96_PREPARE_STEP_NONE;
+				break;
+		}
+
+		/* The firmware version is fetched once (state may have become known through status replies alone) */
+		if( (prepare->step == VMC96_PREPARE_STEP_VERSION) && (session->version[0] != '\0') )
+			prepare->step = VMC96_PREPARE_STEP_NONE;
 
-			if( result->array.motor[ row ][ col ] )
-				result->count++;
+		switch( prepare->step )
+		{
+			case VMC96_PREPARE_STEP_NONE:
+				return ret;
+
+			case VMC96_PREPARE_STEP_PROBE:
+				memset( &prepare->status, 0, sizeof(VMC96_motor_array_status_t) );
+				ret = vmc96_start_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STATUS_REQUEST, NULL, 0, vmc96_decode_motor_status, &prepare->status );
+				break;
+
+			case VMC96_PREPARE_STEP_STOP:
+				ret = vmc96_start_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_STOP_ALL, NULL, 0, NULL, NULL );
+				break;
+
+			case VMC96_PREPARE_STEP_RESET:
+				ret = vmc96_start_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_RESET, NULL, 0, NULL, NULL );
+				break;
+
+			default:
+				prepare->version[0] = '\0';
+				ret = vmc96_start_request( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_KERNEL_VERSION, NULL, 0, vmc96_decode_version, prepare->version );
+				break;
 		}
-	}
 
-	return VMC96_SUCCESS;
+		/* Request sent: vmc96_poll() continues from its response */
+		if( ret == VMC96_SUCCESS )
+			return VMC96_ERROR_K1_RESPONSE_PENDING;
+	}
 }
 
 
-int vmc96_motor_give_pulse( VMC96_t * vmc96, unsigned char row, unsigned char col, unsigned char duration_ms )
+int vmc96_motor_prepare( VMC96_t * vmc96 )
 {
-	unsigned char data[2] = { VMC96_GET_MOTOR_ID( row, col ), duration_ms };
+	int ret = 0;
 
-	if( !VMC96_VALIDATE_MOTOR_COORDINATE( row, col) )
-		return VMC96_ERROR_INVALID_MOTOR_COORDINATES;
+	if( vmc96->transaction.pending )
+		return VMC96_ERROR_K1_TRANSACTION_BUSY;
 
-	return vmc96_send_message_ex( vmc96, VMC96_CONTROLLER_MOTOR_ARRAY, VMC96_COMMAND_MOTOR_GIVE_PULSE, data, 2 );
+	vmc96->prepare.step = VMC96_PREPARE_STEP_START;
+
+	ret = vmc96_prepare_advance( vmc96, VMC96_SUCCESS );
+
+	if( ret != VMC96_ERROR_K1_RESPONSE_PENDING )
+		return ret;
+
+	return vmc96_complete_request( vmc96 );
+}
+
+
+int vmc96_motor_get_session( VMC96_t * vmc96, VMC96_session_t * session )
+{
+	memcpy( session, &vmc96->session, sizeof(VMC96_session_t) );
+
+	return VMC96_SUCCESS;
 }
 
 
@@ -489,185 +706,182 @@ int vmc96_global_reset( VMC96_t * vmc96 )
 
 
 /* ********************************************************************* */
-/* *                    MESSAGE CONTROL FUNCTIONS                      * */
+/* *                        RESPONSE DECODERS                          * */
 /* ********************************************************************* */
 
-static unsigned char vmc96_calculate_checksum( unsigned char * buf, size_t buflen )
+static int vmc96_decode_version( VMC96_t * vmc96, void * result )
+{
+	return vmc96_k1_decode_version( &vmc96->response, (char*) result );
+}
+
+
+static int vmc96_decode_motor_status( VMC96_t * vmc96, void * result )
 {
-	unsigned char sum = 0;
-	unsigned long i = 0;
+	int ret = vmc96_k1_decode_motor_status( &vmc96->response, (VMC96_motor_array_status_t*) result );
 
-	for( i = 0; i < buflen; i++ )
-		sum ^= buf[i];
+	if( ret == VMC96_SUCCESS )
+		vmc96_update_run_table( vmc96, (VMC96_motor_array_status_t*) result );
 
-	return sum;
+	return ret;
 }
 
 
-static int vmc96_prepare_k1_message( VMC96_t * vmc96 )
+static int vmc96_decode_opto_line_status( VMC96_t * vmc96, void * result )
 {
-	vmc96->message.k1_length = vmc96->message.data_length + VMC96_K1_MESSAGE_MIN_LEN;
+	return vmc96_k1_decode_opto_line_status( &vmc96->response, (VMC96_opto_line_sample_block_t*) result );
+}
 
-	/* K1 Message STX Header Field */
-	vmc96->message.k1[0] = VMC96_K1_MESSAGE_STX;
 
-	/* K1 Message: Controller Address/ID Field */
-	vmc96->message.k1[1] = vmc96->message.id_controller;
+static int vmc96_decode_scan_array( VMC96_t * vmc96, void * result )
+{
+	return vmc96_k1_decode_scan_array( &vmc96->response, (VMC96_motor_array_scan_result_t*) result );
+}
 
-	/* K1 Message: Total Length Field */
-	vmc96->message.k1[2] = vmc96->message.k1_length;
 
-	/* K1 Message: Command Code Field */
-	vmc96->message.k1[3] = vmc96->message.command;
+/* ********************************************************************* */
+/* *                    MESSAGE CONTROL FUNCTIONS                      * */
+/* ********************************************************************* */
 
-	/* K1 Message: Data Field */
-	if( vmc96->message.data_length > 0 )
-		memcpy( &vmc96->message.k1[4], vmc96->message.data, vmc96->message.data_length );
+unsigned long vmc96_get_time_ms( void )
+{
+#ifdef __linux__
+	struct timespec ts;
 
-	/* K1 Message: Checksum Field */
-	vmc96->message.k1[ vmc96->message.k1_length - 1 ] = vmc96_calculate_checksum( vmc96->message.k1, vmc96->message.k1_length - 1 );
+	clock_gettime( CLOCK_MONOTONIC, &ts );
 
-	return VMC96_SUCCESS;
+	return (unsigned long) ts.tv_sec * 1000UL + (unsigned long) ts.tv_nsec / 1000000UL;
+#elif _WIN32
+	return (unsigned long) GetTickCount();
+#else
+	return (unsigned long) time(NULL) * 1000UL;
+#endif
 }
 
 
-static int vmc96_k1_parse_response_type( VMC96_t * vmc96 )
+#ifdef __linux__
+static int vmc96_tty_write_k1_message( VMC96_t * vmc96 )
 {
-	switch( vmc96->message.id_controller )
+	ssize_t ret = 0;
+	struct pollfd pfd;
+
+	while( vmc96->transaction.sent < vmc96->message.k1_length )
 	{
-		case VMC96_CONTROLLER_GLOBAL_BROADCAST:
-		{
-			switch( vmc96->message.command )
-			{
-				case VMC96_COMMAND_GLOBAL_RESET : return VMC96_K1_RESPONSE_TYPE_ACK;
-				default                         : return VMC96_K1_RESPONSE_TYPE_INVALID;
-			}
-		}
+		ret = write( vmc96->fd, vmc96->message.k1 + vmc96->transaction.sent, vmc96->message.k1_length - vmc96->transaction.sent );
 
-		case VMC96_CONTROLLER_RELAY_1 :
-		case VMC96_CONTROLLER_RELAY_2 :
+		if( ret >= 0 )
 		{
-			switch( vmc96->message.command )
-			{
-				case VMC96_COMMAND_RESET          : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_SIMPLE_PING    : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_KERNEL_VERSION : return VMC96_K1_RESPONSE_TYPE_DATA;
-				case VMC96_COMMAND_RELAY_FUNCTION : return VMC96_K1_RESPONSE_TYPE_ACK;
-				default                           : return VMC96_K1_RESPONSE_TYPE_INVALID;
-			}
+			vmc96->transaction.sent += ret;
+			continue;
 		}
 
-		case VMC96_CONTROLLER_MOTOR_ARRAY:
-		{
-			switch( vmc96->message.command )
-			{
-				case VMC96_COMMAND_RESET                  : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_SIMPLE_PING            : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_KERNEL_VERSION         : return VMC96_K1_RESPONSE_TYPE_DATA;
-				case VMC96_COMMAND_MOTOR_RUN              : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_MOTOR_STOP_ALL         : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_MOTOR_STATUS_REQUEST   : return VMC96_K1_RESPONSE_TYPE_DATA;
-				case VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS : return VMC96_K1_RESPONSE_TYPE_DATA;
-				case VMC96_COMMAND_MOTOR_GIVE_PULSE       : return VMC96_K1_RESPONSE_TYPE_ACK;
-				case VMC96_COMMAND_MOTOR_SCAN_ARRAY       : return VMC96_K1_RESPONSE_TYPE_DATA;
-				default                                   : return VMC96_K1_RESPONSE_TYPE_INVALID;
-			}
-		}
+		if( errno == EINTR )
+			continue;
 
-		default:
-		{
-			return VMC96_K1_RESPONSE_TYPE_INVALID;
-		}
+		if( errno != EAGAIN )
+			return VMC96_ERROR_TTY_WRITE_DATA;
+
+		/* Non-blocking contexts finish the write from vmc96_poll() */
+		if( vmc96->nonblocking )
+			return VMC96_SUCCESS;
+
+		pfd.fd = vmc96->fd;
+		pfd.events = POLLOUT;
+
+		if( poll( &pfd, 1, VMC96_K1_RESPONSE_TIMEOUT_MS ) <= 0 )
+			return VMC96_ERROR_TTY_WRITE_DATA;
 	}
+
+	return VMC96_SUCCESS;
 }
 
 
-static int vmc96_parse_k1_response( VMC96_t * vmc96 )
+static int vmc96_tty_send_k1_message( VMC96_t * vmc96 )
 {
-	switch( vmc96_k1_parse_response_type( vmc96 ) )
-	{
-		case VMC96_K1_RESPONSE_TYPE_ACK:
-		{
-			/* K1 Response: Validate Positive ACK Message Len */
-			if( vmc96->response.k1_length != VMC96_K1_MESSAGE_MIN_LEN )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+	if( tcflush( vmc96->fd, TCIOFLUSH ) < 0 )
+		return VMC96_ERROR_TTY_FLUSH_BUFFERS;
 
-			/* K1 Response: Parse Source Controller ID/Address Field */
-			vmc96->response.id_controller = vmc96->response.k1[1];
+	vmc96->transaction.sent = 0;
+	vmc96->response.k1_length = 0;
 
-			/* K1 Response: Data Field Empty */
-			memset( vmc96->response.data, 0, VMC96_K1_MESSAGE_DATA_MAX_LEN );
-			vmc96->response.data_length = 0;
+	return vmc96_tty_write_k1_message( vmc96 );
+}
 
-			/* K1 Response: Validating STX Header Field */
-			if( vmc96->response.k1[0] != VMC96_K1_MESSAGE_STX )
-				return VMC96_ERROR_K1_RESPONSE_MALFORMED;
 
-			/* K1 Response: Validate Source Controller ID/Address Field */
-			if( vmc96->response.k1[1] != vmc96->message.id_controller )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
+static int vmc96_tty_receive_k1_response( VMC96_t * vmc96 )
+{
+	ssize_t ret = 0;
 
-			/* K1 Response: Validate Positive ACK Message Len */
-			if( vmc96->response.k1[2] != VMC96_K1_MESSAGE_MIN_LEN )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+	/* Request not fully written yet (non-blocking mode) */
+	if( vmc96->transaction.sent < vmc96->message.k1_length )
+	{
+		ret = vmc96_tty_write_k1_message( vmc96 );
 
-			/* K1 Response: Validate Checksum */
-			if( vmc96->response.k1[4] != vmc96_calculate_checksum( vmc96->response.k1, vmc96->response.k1_length - 1 ) )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_CHECKSUM;
+		if( ret != VMC96_SUCCESS )
+			return (int) ret;
 
-			/* K1 Response: Validate Positive ACK Field */
-			if( vmc96->response.k1[3] != VMC96_K1_RESPONSE_POSITIVE_ACK )
-				return VMC96_ERROR_K1_RESPONSE_NEGATIVE_ACK;
+		if( vmc96->transaction.sent < vmc96->message.k1_length )
+			return VMC96_ERROR_K1_RESPONSE_PENDING;
+	}
 
-			return VMC96_SUCCESS;
-		}
+	ret = read( vmc96->fd, vmc96->response.k1 + vmc96->response.k1_length, VMC96_K1_MESSAGE_MAX_LEN - vmc96->response.k1_length );
 
-		case VMC96_K1_RESPONSE_TYPE_DATA:
-		{
-			/* K1 Response: Validating Message Length */
-			if( vmc96->response.k1_length < VMC96_K1_MESSAGE_MIN_LEN )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+	if( ret < 0 )
+	{
+		if( (errno != EAGAIN) && (errno != EINTR) )
+			return VMC96_ERROR_TTY_READ_DATA;
 
-			/* K1 Response: Parse Source Controller ID/Address Field */
-			vmc96->response.id_controller = vmc96->response.k1[1];
+		ret = 0;
+	}
 
-			/* K1 Response: Parse Total Data Length Field */
-			vmc96->response.data_length = vmc96->response.k1[2] - 4;
+	vmc96->response.k1_length += ret;
 
-			/* K1 Response: Parse Data Field */
-			memcpy( vmc96->response.data, &vmc96->response.k1[3], vmc96->response.data_length );
+	if( !vmc96_k1_frame_complete( vmc96->response.k1, vmc96->response.k1_length ) )
+		return VMC96_ERROR_K1_RESPONSE_PENDING;
 
-			/* K1 Response: Validating STX Header Field */
-			if( vmc96->response.k1[0] != VMC96_K1_MESSAGE_STX )
-				return VMC96_ERROR_K1_RESPONSE_MALFORMED;
+	return VMC96_SUCCESS;
+}
+#endif
 
-			/* K1 Response: Validate Source Controller ID/Address Field */
-			if( vmc96->response.k1[1] != vmc96->message.id_controller )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
 
-			/* K1 Response: Validate Total Length Field */
-			if( vmc96->response.k1[2] != vmc96->response.k1_length )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+static void vmc96_wait_k1_response( VMC96_t * vmc96 )
+{
+#ifdef __linux__
+	long remaining = 0;
+	struct pollfd pfd;
 
-			/* K1 Response: Validate Checksum */
-			if( vmc96->response.k1[ vmc96->response.k1_length - 1 ] != vmc96_calculate_checksum( vmc96->response.k1, vmc96->response.k1_length - 1 ) )
-				return VMC96_ERROR_K1_RESPONSE_INVALID_CHECKSUM;
+	if( vmc96->fd >= 0 )
+	{
+		remaining = (long) (vmc96->transaction.deadline_ms - vmc96_get_time_ms());
 
-			return VMC96_SUCCESS;
-		}
+		pfd.fd = vmc96->fd;
+		pfd.events = POLLIN;
 
-		default:
-		{
-			return VMC96_ERROR_K1_RESPONSE_MALFORMED;
-		}
+		/* Wake up as soon as response bytes arrive */
+		poll( &pfd, 1, ( remaining > 0 ) ? (int) remaining : 0 );
+		return;
 	}
+#endif
+
+	VMC96_SLEEP_MS( VMC96_K1_RESPONSE_READ_RETRY_DELAY_MS );
 }
 
 
 static int vmc96_send_k1_message( VMC96_t * vmc96 )
 {
 	int ret = 0;
-	int i = 0;
+
+	/* The transport takes the frame through vmc96_get_request_frame() */
+	if( vmc96->external_io )
+	{
+		vmc96->transaction.sent = 0;
+		vmc96->response.k1_length = 0;
+		return VMC96_SUCCESS;
+	}
+
+#ifdef __linux__
+	if( vmc96->fd >= 0 )
+		return vmc96_tty_send_k1_message( vmc96 );
+#endif
 
 	ret = ftdi_usb_purge_buffers( vmc96->ftdi );
 
@@ -679,23 +893,34 @@ static int vmc96_send_k1_message( VMC96_t * vmc96 )
 	if( ret < 0 )
 		return VMC96_ERROR_FTDI_WRITE_DATA;
 
-	for( i = 0; i < VMC96_K1_RESPONSE_TIMEOUT_MS; i += VMC96_K1_RESPONSE_READ_RETRY_DELAY_MS  )
-	{
-		VMC96_SLEEP_MS( VMC96_K1_RESPONSE_READ_RETRY_DELAY_MS );
+	vmc96->transaction.sent = vmc96->message.k1_length;
+
+	vmc96->response.k1_length = 0;
 
-		ret = ftdi_read_data( vmc96->ftdi, vmc96->response.k1, VMC96_K1_MESSAGE_MAX_LEN );
+	return VMC96_SUCCESS;
+}
 
-		if( ret < 0 )
-			return VMC96_ERROR_FTDI_READ_DATA;
 
-		if( ret > 0 )
-		{
-			vmc96->response.k1_length = ret;
-			return VMC96_SUCCESS;
-		}
-	}
+static int vmc96_receive_k1_response( VMC96_t * vmc96 )
+{
+	int ret = 0;
+
+#ifdef __linux__
+	if( vmc96->fd >= 0 )
+		return vmc96_tty_receive_k1_response( vmc96 );
+#endif
+
+	ret = ftdi_read_data( vmc96->ftdi, vmc96->response.k1 + vmc96->response.k1_length, VMC96_K1_MESSAGE_MAX_LEN - vmc96->response.k1_length );
+
+	if( ret < 0 )
+		return VMC96_ERROR_FTDI_READ_DATA;
 
-	return VMC96_ERROR_K1_RESPONSE_TIMEOUT;
+	vmc96->response.k1_length += ret;
+
+	if( !vmc96_k1_frame_complete( vmc96->response.k1, vmc96->response.k1_length ) )
+		return VMC96_ERROR_K1_RESPONSE_PENDING;
+
+	return VMC96_SUCCESS;
 }
 
 
@@ -706,9 +931,18 @@ static int vmc96_send_message( VMC96_t * vmc96, unsigned char id_cntlr, unsigned
 
 
 static int vmc96_send_message_ex( VMC96_t * vmc96, unsigned char id_cntlr, unsigned char cmd, unsigned char * data, unsigned char datalen )
+{
+	return vmc96_send_request( vmc96, id_cntlr, cmd, data, datalen, NULL, NULL );
+}
+
+
+static int vmc96_start_request( VMC96_t * vmc96, unsigned char id_cntlr, unsigned char cmd, unsigned char * data, unsigned char datalen, vmc96_decoder_t decoder, void * result )
 {
 	int ret = 0;
 
+	if( vmc96->transaction.pending )
+		return VMC96_ERROR_K1_TRANSACTION_BUSY;
+
 	vmc96->message.id_controller = id_cntlr;
 	vmc96->message.command = cmd;
 
@@ -721,7 +955,7 @@ static int vmc96_send_message_ex( VMC96_t * vmc96, unsigned char id_cntlr, unsig
 		vmc96->message.data_length = datalen;
 	}
 
-	ret = vmc96_prepare_k1_message( vmc96 );
+	ret = vmc96_prepare_k1_message( &vmc96->message );
 
 	if( ret != VMC96_SUCCESS )
 		return ret;
@@ -730,12 +964,194 @@ static int vmc96_send_message_ex( VMC96_t * vmc96, unsigned char id_cntlr, unsig
 
 	ret = vmc96_send_k1_message( vmc96 );
 
+	if( ret != VMC96_SUCCESS )
+	{
+		/* Part of the request may have reached the controller */
+		vmc96_update_session( vmc96, ret );
+		return ret;
+	}
+
+	vmc96->transaction.pending = 1;
+	vmc96->transaction.deadline_ms = vmc96_get_time_ms() + VMC96_K1_RESPONSE_TIMEOUT_MS;
+	vmc96->transaction.decoder = decoder;
+	vmc96->transaction.result = result;
+
+	return VMC96_SUCCESS;
+}
+
+
+static int vmc96_complete_request( VMC96_t * vmc96 )
+{
+	int ret = 0;
+
+	if( vmc96->nonblocking || vmc96->external_io )
+		return VMC96_ERROR_K1_RESPONSE_PENDING;
+
+	do
+	{
+		vmc96_wait_k1_response( vmc96 );
+
+		ret = vmc96_poll( vmc96 );
+
+	} while( ret == VMC96_ERROR_K1_RESPONSE_PENDING );
+
+	return ret;
+}
+
+
+static int vmc96_send_request( VMC96_t * vmc96, unsigned char id_cntlr, unsigned char cmd, unsigned char * data, unsigned char datalen, vmc96_decoder_t decoder, void * result )
+{
+	int ret = vmc96_start_request( vmc96, id_cntlr, cmd, data, datalen, decoder, result );
+
 	if( ret != VMC96_SUCCESS )
 		return ret;
 
-	VMC96_DEBUG_BUFFER( "K1-RESPONSE", vmc96->response.k1, vmc96->response.k1_length );
+	return vmc96_complete_request( vmc96 );
+}
+
+
+/* ********************************************************************* */
+/* *                     NON-BLOCKING TRANSACTIONS                     * */
+/* ********************************************************************* */
+
+int vmc96_set_nonblocking( VMC96_t * vmc96, int enable )
+{
+	if( vmc96->transaction.pending )
+		return VMC96_ERROR_K1_TRANSACTION_BUSY;
+
+	vmc96->nonblocking = ( enable ) ? 1 : 0;
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_write_pending( VMC96_t * vmc96 )
+{
+	return vmc96->transaction.pending && ( vmc96->transaction.sent < vmc96->message.k1_length );
+}
+
+
+unsigned long vmc96_get_deadline_ms( VMC96_t * vmc96 )
+{
+	return vmc96->transaction.deadline_ms;
+}
+
+
+int vmc96_poll( VMC96_t * vmc96 )
+{
+	int ret = 0;
+
+	if( !vmc96->transaction.pending )
+		return VMC96_SUCCESS;
 
-	return vmc96_parse_k1_response( vmc96 );
+	/* The external transport owns the descriptor and the deadline */
+	if( vmc96->external_io )
+		return VMC96_ERROR_K1_RESPONSE_PENDING;
+
+	ret = vmc96_receive_k1_response( vmc96 );
+
+	if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+	{
+		/* Unsigned difference survives clock wrap-around */
+		if( (long) (vmc96_get_time_ms() - vmc96->transaction.deadline_ms) < 0 )
+			return VMC96_ERROR_K1_RESPONSE_PENDING;
+
+		ret = VMC96_ERROR_K1_RESPONSE_TIMEOUT;
+	}
+
+	return vmc96_complete_transaction( vmc96, ret );
+}
+
+
+/* ********************************************************************* */
+/* *                            EXTERNAL I/O                           * */
+/* ********************************************************************* */
+
+int vmc96_set_external_io( VMC96_t * vmc96, int enable )
+{
+	if( vmc96->transaction.pending )
+		return VMC96_ERROR_K1_TRANSACTION_BUSY;
+
+	if( enable && (vmc96->fd < 0) )
+		return VMC96_ERROR_TTY_OPEN_DEVICE;
+
+	vmc96->external_io = ( enable ) ? 1 : 0;
+
+	return VMC96_SUCCESS;
+}
+
+
+size_t vmc96_get_request_frame( VMC96_t * vmc96, const unsigned char ** frame )
+{
+	size_t length = 0;
+
+	if( !vmc96->transaction.pending || (vmc96->transaction.sent >= vmc96->message.k1_length) )
+		return 0;
+
+	length = vmc96->message.k1_length - vmc96->transaction.sent;
+
+	*frame = vmc96->message.k1 + vmc96->transaction.sent;
+
+	/* Handed over: the transport writes it from now on */
+	vmc96->transaction.sent = vmc96->message.k1_length;
+
+	return length;
+}
+
+
+int vmc96_deliver_response( VMC96_t * vmc96, const unsigned char * data, size_t length )
+{
+	size_t room = 0;
+
+	/* Late bytes of a completed transaction are dropped */
+	if( !vmc96->transaction.pending )
+		return VMC96_SUCCESS;
+
+	room = VMC96_K1_MESSAGE_MAX_LEN - vmc96->response.k1_length;
+
+	if( length > room )
+		length = room;
+
+	memcpy( vmc96->response.k1 + vmc96->response.k1_length, data, length );
+	vmc96->response.k1_length += length;
+
+	if( !vmc96_k1_frame_complete( vmc96->response.k1, vmc96->response.k1_length ) )
+		return VMC96_ERROR_K1_RESPONSE_PENDING;
+
+	return vmc96_complete_transaction( vmc96, VMC96_SUCCESS );
+}
+
+
+int vmc96_abort_transaction( VMC96_t * vmc96, int error )
+{
+	if( !vmc96->transaction.pending )
+		return VMC96_SUCCESS;
+
+	return vmc96_complete_transaction( vmc96, error );
+}
+
+
+static int vmc96_complete_transaction( VMC96_t * vmc96, int ret )
+{
+	vmc96->transaction.pending = 0;
+
+	if( ret == VMC96_SUCCESS )
+	{
+		VMC96_DEBUG_BUFFER( "K1-RESPONSE", vmc96->response.k1, vmc96->response.k1_length );
+
+		ret = vmc96_parse_k1_response( &vmc96->message, &vmc96->response );
+
+		if( (ret == VMC96_SUCCESS) && vmc96->transaction.decoder )
+			ret = vmc96->transaction.decoder( vmc96, vmc96->transaction.result );
+	}
+
+	vmc96_update_session( vmc96, ret );
+
+	/* vmc96_motor_prepare() sends its next request from here */
+	if( vmc96->prepare.step != VMC96_PREPARE_STEP_NONE )
+		ret = vmc96_prepare_advance( vmc96, ret );
+
+	return ret;
 }
 
 
@@ -745,6 +1161,17 @@ static int vmc96_send_message_ex( VMC96_t * vmc96, unsigned char id_cntlr, unsig
 
 void vmc96_finish( VMC96_t * vmc96 )
 {
+#ifdef __linux__
+	if( vmc96->fd >= 0 )
+	{
+		close( vmc96->fd );
+		free( vmc96 );
+
+		VMC96_DEBUG_MSG( "[DEBUG] Disconnected from VMC96 Board.\n");
+		return;
+	}
+#endif
+
 	ftdi_usb_close( vmc96->ftdi );
 	ftdi_free( vmc96->ftdi );
 	free( vmc96 );
@@ -763,6 +1190,8 @@ int vmc96_initialize( VMC96_t ** ppvmc96 )
 	if( !vmc96 )
 		return VMC96_ERROR_OUT_OF_MEMORY;
 
+	vmc96->fd = -1;
+
 	vmc96->ftdi = ftdi_new();
 
 	if( !vmc96->ftdi )
@@ -840,4 +1269,79 @@ error_cleanup:
 	return ret;
 }
 
+
+int vmc96_initialize_tty( VMC96_t ** ppvmc96, const char * device )
+{
+#ifdef __linux__
+	int ret = 0;
+	VMC96_t * vmc96 = NULL;
+	struct termios tio;
+
+	vmc96 = (VMC96_t*) calloc( 1, sizeof(VMC96_t) );
+
+	if( !vmc96 )
+		return VMC96_ERROR_OUT_OF_MEMORY;
+
+	vmc96->fd = open( device, O_RDWR | O_NOCTTY | O_NONBLOCK );
+
+	if( vmc96->fd < 0 )
+	{
+		ret = VMC96_ERROR_TTY_OPEN_DEVICE;
+		goto error_cleanup;
+	}
+
+	if( tcgetattr( vmc96->fd, &tio ) < 0 )
+	{
+		ret = VMC96_ERROR_TTY_SET_ATTRIBUTES;
+		goto error_cleanup;
+	}
+
+	/* Raw 8N1, no flow control */
+	cfmakeraw( &tio );
+	cfsetispeed( &tio, B19200 );
+	cfsetospeed( &tio, B19200 );
+	tio.c_cflag |= ( CLOCAL | CREAD );
+	tio.c_cflag &= ~( CSTOPB | CRTSCTS );
+	tio.c_cc[ VMIN ] = 0;
+	tio.c_cc[ VTIME ] = 0;
+
+	if( tcsetattr( vmc96->fd, TCSANOW, &tio ) < 0 )
+	{
+		ret = VMC96_ERROR_TTY_SET_ATTRIBUTES;
+		goto error_cleanup;
+	}
+
+	*ppvmc96 = vmc96;
+
+	VMC96_DEBUG_FMT_MSG( "[DEBUG] VMC96 board initialized successfully (%s).\n", device );
+
+	return VMC96_SUCCESS;
+
+error_cleanup:
+
+	*ppvmc96 = NULL;
+
+	VMC96_DEBUG_FMT_MSG( "[DEBUG] Cannot initialize VMC96 board: %s\n", vmc96_get_error_code_string(ret) );
+
+	if( vmc96->fd >= 0 )
+		close( vmc96->fd );
+
+	free( vmc96 );
+
+	return ret;
+#else
+	(void) device;
+
+	*ppvmc96 = NULL;
+
+	return VMC96_ERROR_TTY_OPEN_DEVICE;
+#endif
+}
+
+
+int vmc96_get_fd( VMC96_t * vmc96 )
+{
+	return vmc96->fd;
+}
+
 /* eof */
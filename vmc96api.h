@@ -28,6 +28,8 @@
 #ifndef __VMC96_H__
 #define __VMC96_H__
 
+#include <stddef.h>
+
 
 #define VMC96_SUCCESS                              (0)
 #define VMC96_ERROR_OUT_OF_MEMORY                  (1)
@@ -47,7 +49,23 @@
 #define VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE     (204)
 #define VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH     (205)
 #define VMC96_ERROR_K1_RESPONSE_TIMEOUT            (206)
+#define VMC96_ERROR_K1_RESPONSE_PENDING            (207)
+#define VMC96_ERROR_K1_TRANSACTION_BUSY            (208)
 #define VMC96_ERROR_INVALID_MOTOR_COORDINATES      (301)
+#define VMC96_ERROR_TTY_OPEN_DEVICE                (401)
+#define VMC96_ERROR_TTY_SET_ATTRIBUTES             (402)
+#define VMC96_ERROR_TTY_WRITE_DATA                 (403)
+#define VMC96_ERROR_TTY_READ_DATA                  (404)
+#define VMC96_ERROR_TTY_FLUSH_BUFFERS              (405)
+#define VMC96_ERROR_BUDGET_TOO_MANY_BOARDS         (501)
+#define VMC96_ERROR_BUDGET_UNKNOWN_BOARD           (502)
+#define VMC96_ERROR_BUDGET_QUEUE_FULL              (503)
+#define VMC96_ERROR_BUDGET_EXCEEDS_LIMIT           (504)
+#define VMC96_ERROR_BUDGET_RUN_QUEUED              (505)
+#define VMC96_ERROR_URING_SETUP                    (601)
+#define VMC96_ERROR_URING_TOO_MANY_BOARDS          (602)
+#define VMC96_ERROR_URING_UNKNOWN_BOARD            (603)
+#define VMC96_ERROR_URING_SUBMIT                   (604)
 
 #define VMC96_OPTO_LINE_SAMPLE_BLOCK_LENGTH_MS     (1280)  /* 1.28s block */
 #define VMC96_OPTO_LINE_SAMPLE_LENGTH_MS           (40)    /* 40ms sample */
@@ -56,12 +74,21 @@
 #define VMC96_MOTOR_ARRAY_ROWS_COUNT               (8)
 #define VMC96_MOTOR_ARRAY_COLUMNS_COUNT            (12)
 
+#define VMC96_SESSION_STATE_UNKNOWN                (0)
+#define VMC96_SESSION_STATE_IDLE                   (1)
+#define VMC96_SESSION_STATE_BUSY                   (2)
+#define VMC96_SESSION_STALE_MS                     (5000)  /* Probe the controller after 5s of silence */
+
 
 typedef struct VMC96_s                         VMC96_t;
 typedef struct VMC96_motor_array_s             VMC96_motor_array_t;
 typedef struct VMC96_motor_array_scan_result_s VMC96_motor_array_scan_result_t;
 typedef struct VMC96_motor_array_status_s      VMC96_motor_array_status_t;
 typedef struct VMC96_opto_line_sample_block_s  VMC96_opto_line_sample_block_t;
+typedef struct VMC96_motor_run_info_s          VMC96_motor_run_info_t;
+typedef struct VMC96_motor_run_table_s         VMC96_motor_run_table_t;
+typedef struct VMC96_motor_run_delta_s         VMC96_motor_run_delta_t;
+typedef struct VMC96_session_s                 VMC96_session_t;
 
 
 /*!
@@ -103,6 +130,53 @@ struct VMC96_motor_array_scan_result_s
 };
 
 
+/*!
+	\brief Represents the Run History of a Single Motor
+*/
+struct VMC96_motor_run_info_s
+{
+	unsigned char running;          /*!< Motor Active in the Last Status Response */
+	unsigned long first_seen_ms;    /*!< Monotonic Time the Current (or Last) Run was First Seen */
+	unsigned long last_seen_ms;     /*!< Monotonic Time the Motor was Last Seen Active */
+};
+
+
+/*!
+	\brief Represents the Running Motors Table kept by the Context
+*/
+struct VMC96_motor_run_table_s
+{
+	VMC96_motor_run_info_t motor[ VMC96_MOTOR_ARRAY_ROWS_COUNT ][ VMC96_MOTOR_ARRAY_COLUMNS_COUNT ]; /*!< Per Motor History */
+	unsigned char running_count;    /*!< Active Motors Count */
+	unsigned int current_ma;        /*!< Total Current Drained in Milliamperes */
+	unsigned long updated_ms;       /*!< Monotonic Time of the Last Status Response */
+};
+
+
+/*!
+	\brief Represents the Motors that Started/Stopped Since the Last Query
+*/
+struct VMC96_motor_run_delta_s
+{
+	VMC96_motor_array_t started;    /*!< Motors Seen Starting */
+	VMC96_motor_array_t stopped;    /*!< Motors Seen Stopping */
+	unsigned char started_count;    /*!< Started Motors Count */
+	unsigned char stopped_count;    /*!< Stopped Motors Count */
+};
+
+
+/*!
+	\brief Represents the Motor Array Controller State known by the Context
+*/
+struct VMC96_session_s
+{
+	int enabled;                    /*!< Session Mode Enabled */
+	int state;                      /*!< VMC96_SESSION_STATE_UNKNOWN, _IDLE or _BUSY */
+	unsigned long last_success_ms;  /*!< Monotonic Time of the Last Successful Transaction */
+	char version[ VMC96_VERSION_STRING_MAX_LEN + 1 ]; /*!< Cached Firmware Version ("" if unknown) */
+};
+
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -115,6 +189,25 @@ extern "C"
 	*/
 	int vmc96_initialize( VMC96_t ** vmc96 );
 
+	/*!
+		\brief Create a VMC96 Context Object over a serial TTY device (ftdi_sio driver).
+		\param vmc96 VMC96 Context Object To be Created.
+		\param device Path to the TTY device (eg: "/dev/ttyUSB0").
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_initialize_tty( VMC96_t ** vmc96, const char * device );
+
+	/*!
+		\brief Retrieve the file descriptor the board is attached to.
+
+		Only TTY contexts have one. In non-blocking mode it can be watched for
+		readability (poll/epoll) to call vmc96_poll() only when response bytes arrive.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\return Returns the file descriptor, or -1 for libftdi contexts.
+	*/
+	int vmc96_get_fd( VMC96_t * vmc96 );
+
 	/*!
 		\brief Destroy a VMC96 Context Object.
 		\param vmc96 Pointer to VMC96 context object to be destroyed.
@@ -122,6 +215,93 @@ extern "C"
 	*/
 	void vmc96_finish( VMC96_t * vmc96 );
 
+	/*!
+		\brief Enable/Disable Non-Blocking Mode.
+
+		In non-blocking mode every command function only sends its request and
+		returns VMC96_ERROR_K1_RESPONSE_PENDING. The transaction is completed by
+		calling vmc96_poll() until it returns anything else. Output buffers passed
+		to the command function must remain valid until then.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param enable Non-zero to enable non-blocking mode.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_set_nonblocking( VMC96_t * vmc96, int enable );
+
+	/*!
+		\brief Make progress on the pending transaction without blocking.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\return Returns VMC96_ERROR_K1_RESPONSE_PENDING while the response is incomplete,
+		        otherwise the result of the pending command (VMC96_SUCCESS if there is none).
+	*/
+	int vmc96_poll( VMC96_t * vmc96 );
+
+	/*!
+		\brief Check whether the pending request is still being written.
+
+		In non-blocking mode a request the TTY can not take at once is finished
+		by vmc96_poll(); meanwhile the descriptor should also be watched for
+		writability.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\return Returns non-zero while request bytes remain unsent.
+	*/
+	int vmc96_write_pending( VMC96_t * vmc96 );
+
+	/*!
+		\brief Retrieve when the pending transaction times out.
+
+		Once this time (vmc96_get_time_ms() clock) has passed, vmc96_poll() completes
+		the transaction with VMC96_ERROR_K1_RESPONSE_TIMEOUT even if no byte arrived,
+		so event loops must call it by then whatever the descriptor reports.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\return Returns the deadline in milliseconds (meaningless without a pending transaction).
+	*/
+	unsigned long vmc96_get_deadline_ms( VMC96_t * vmc96 );
+
+	/*!
+		\brief Enable/Disable External I/O (TTY contexts only).
+
+		The TTY is then driven by another transport (see vmc96uring.h): command
+		functions only build their request and return VMC96_ERROR_K1_RESPONSE_PENDING,
+		the transport writes vmc96_get_request_frame() and hands the response bytes to
+		vmc96_deliver_response(). RX/TX buffers are not flushed before each request
+		and vmc96_poll() no longer reads or times out.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param enable Non-zero to enable external I/O.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_set_external_io( VMC96_t * vmc96, int enable );
+
+	/*!
+		\brief Take the request frame the external transport has to write.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param frame Receives a pointer to the frame, valid until the transaction completes.
+		\return Returns the frame length, or 0 if there is no request left to write.
+	*/
+	size_t vmc96_get_request_frame( VMC96_t * vmc96, const unsigned char ** frame );
+
+	/*!
+		\brief Hand response bytes read by the external transport to the pending transaction.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param data Bytes read from the TTY.
+		\param length Number of bytes.
+		\return Returns VMC96_ERROR_K1_RESPONSE_PENDING while the frame is incomplete (or
+		        vmc96_motor_prepare() sent its next request), otherwise the result of the command.
+	*/
+	int vmc96_deliver_response( VMC96_t * vmc96, const unsigned char * data, size_t length );
+
+	/*!
+		\brief Complete the pending transaction with an error (timeout or I/O failure).
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param error Error code the command fails with.
+		\return Returns the error, or VMC96_ERROR_K1_RESPONSE_PENDING if vmc96_motor_prepare() sent its next request.
+	*/
+	int vmc96_abort_transaction( VMC96_t * vmc96, int error );
+
 	/*!
 		\brief Translate an error code to a human readable string.
 		\param cod Error code to translate.
@@ -252,6 +432,80 @@ extern "C"
 	*/
 	int vmc96_motor_give_pulse( VMC96_t * vmc96, unsigned char row, unsigned char col, unsigned char duration_ms );
 
+	/*!
+		\brief Enable/Disable Session Mode.
+
+		The context always tracks the motor array controller state from the
+		replies it receives. Session mode lets vmc96_motor_prepare() trust it.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param enable Non-zero to enable session mode.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_set_session( VMC96_t * vmc96, int enable );
+
+	/*!
+		\brief Bring the Motor Array Controller to a Known Idle State Before a Vend.
+
+		Without session mode it always resets the controller. In session mode it
+		resets only when the state is unknown or the last transaction failed,
+		probes the status when the controller is busy or was silent for
+		VMC96_SESSION_STALE_MS, fetches the firmware version once, and otherwise
+		returns without talking to the board. In non-blocking mode it returns
+		VMC96_ERROR_K1_RESPONSE_PENDING when the board must be contacted; vmc96_poll()
+		then sends each following request itself and finally returns the result
+		of the whole preparation.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_motor_prepare( VMC96_t * vmc96 );
+
+	/*!
+		\brief Retrieve the Motor Array Controller Session State.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param session Session state to be filled.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_motor_get_session( VMC96_t * vmc96, VMC96_session_t * session );
+
+	/*!
+		\brief Retrieve the Running Motors Table.
+
+		The table is updated by every successful vmc96_motor_get_status() call and
+		cleared when a stop all, motor reset or global reset is acknowledged;
+		this function does not talk to the board.
+
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param table Table to be filled.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_motor_get_run_table( VMC96_t * vmc96, VMC96_motor_run_table_t * table );
+
+	/*!
+		\brief Retrieve the Motors that Started/Stopped Since the Last Call.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param delta Changes observed by status responses since the previous call.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_motor_get_run_delta( VMC96_t * vmc96, VMC96_motor_run_delta_t * delta );
+
+	/*!
+		\brief Retrieve how Long a Motor Has Been Running.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\param row Motor Array Row Coordinate.
+		\param col Motor Array Column Coordinate.
+		\return Returns the time since the motor was first seen active if it is
+		        running, the observed length of its last run otherwise (0 if never seen).
+	*/
+	unsigned long vmc96_motor_get_run_duration_ms( VMC96_t * vmc96, unsigned char row, unsigned char col );
+
+	/*!
+		\brief Monotonic Clock used for all library timestamps.
+		\return Returns the current time in milliseconds.
+	*/
+	unsigned long vmc96_get_time_ms( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,365 @@
+/*!
+	\file vmc96budget.c
+	\brief Machine-Wide Motor Current Budget across several VMC96 Boards
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vmc96api.h"
+#include "vmc96budget.h"
+
+
+/* ********************************************************************* */
+/* *                        STRUCTS AND DATA TYPES                     * */
+/* ********************************************************************* */
+
+typedef struct vmc96_budget_run_s vmc96_budget_run_t;
+typedef struct vmc96_budget_reservation_s vmc96_budget_reservation_t;
+
+
+struct vmc96_budget_run_s
+{
+	VMC96_t * vmc96;
+	unsigned char row;
+	unsigned char col;
+	VMC96_budget_callback_t callback;
+	void * arg;
+};
+
+
+struct vmc96_budget_reservation_s
+{
+	int board;
+	unsigned char row;
+	unsigned char col;
+	unsigned long time_ms;
+};
+
+
+struct VMC96_budget_s
+{
+	unsigned int limit_ma;
+	unsigned int motor_estimate_ma;
+
+	VMC96_t * board[ VMC96_BUDGET_MAX_BOARDS ];
+	VMC96_motor_run_table_t table[ VMC96_BUDGET_MAX_BOARDS ];
+	int board_count;
+
+	vmc96_budget_run_t queue[ VMC96_BUDGET_MAX_QUEUED_RUNS ];
+	int queue_head;
+	int queue_count;
+
+	vmc96_budget_reservation_t reservation[ VMC96_BUDGET_MAX_RESERVATIONS ];
+	int reservation_count;
+};
+
+
+/* ********************************************************************* */
+/* *                        PRIVATE PROTOTYPES                         * */
+/* ********************************************************************* */
+
+/*!
+	\brief Find Attached Board Index
+	\param budget
+	\param vmc96
+	\return
+*/
+static int vmc96_budget_find_board( VMC96_budget_t * budget, VMC96_t * vmc96 );
+
+/*!
+	\brief Reload Board Tables, Drop Settled Reservations and Compute Load
+	\param budget
+	\return
+*/
+static unsigned int vmc96_budget_refresh( VMC96_budget_t * budget );
+
+/*!
+	\brief Run a Motor and Reserve its Current
+	\param budget
+	\param board
+	\param row
+	\param col
+	\return
+*/
+static int vmc96_budget_admit( VMC96_budget_t * budget, int board, unsigned char row, unsigned char col );
+
+
+/* ********************************************************************* */
+/* *                          IMPLEMENTATION                           * */
+/* ********************************************************************* */
+
+static int vmc96_budget_find_board( VMC96_budget_t * budget, VMC96_t * vmc96 )
+{
+	int i = 0;
+
+	for( i = 0; i < budget->board_count; i++ )
+		if( budget->board[i] == vmc96 )
+			return i;
+
+	return -1;
+}
+
+
+static unsigned int vmc96_budget_refresh( VMC96_budget_t * budget )
+{
+	unsigned int load = 0;
+	int i = 0;
+
+	for( i = 0; i < budget->board_count; i++ )
+	{
+		vmc96_motor_get_run_table( budget->board[i], &budget->table[i] );
+		load += budget->table[i].current_ma;
+	}
+
+	i = 0;
+
+	while( i < budget->reservation_count )
+	{
+		vmc96_budget_reservation_t * res = &budget->reservation[i];
+		const VMC96_motor_run_table_t * table = &budget->table[ res->board ];
+		long age_ms = (long) (table->updated_ms - res->time_ms);
+		int running = table->motor[ res->row ][ res->col ].running;
+
+		/* Only a status read after the run can account for its current: either it
+		   shows the motor running, or it was read long enough after to miss it */
+		if( ((age_ms >= 0) && running) || ((age_ms >= VMC96_BUDGET_RESERVATION_TIMEOUT_MS) && !running) )
+		{
+			budget->reservation[i] = budget->reservation[ --budget->reservation_count ];
+			continue;
+		}
+
+		i++;
+	}
+
+	return load + budget->reservation_count * budget->motor_estimate_ma;
+}
+
+
+static int vmc96_budget_admit( VMC96_budget_t * budget, int board, unsigned char row, unsigned char col )
+{
+	vmc96_budget_reservation_t * res = NULL;
+	int ret = 0;
+
+	ret = vmc96_motor_run( budget->board[ board ], row, col );
+
+	if( ret != VMC96_SUCCESS )
+		return ret;
+
+	res = &budget->reservation[ budget->reservation_count++ ];
+
+	res->board = board;
+	res->row = row;
+	res->col = col;
+	res->time_ms = vmc96_get_time_ms();
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_budget_motor_run( VMC96_budget_t * budget, VMC96_t * vmc96, unsigned char row, unsigned char col, VMC96_budget_callback_t callback, void * arg )
+{
+	vmc96_budget_run_t * run = NULL;
+	unsigned int load = 0;
+	int board = 0;
+
+	board = vmc96_budget_find_board( budget, vmc96 );
+
+	if( board < 0 )
+		return VMC96_ERROR_BUDGET_UNKNOWN_BOARD;
+
+	if( (row >= VMC96_MOTOR_ARRAY_ROWS_COUNT) || (col >= VMC96_MOTOR_ARRAY_COLUMNS_COUNT) )
+		return VMC96_ERROR_INVALID_MOTOR_COORDINATES;
+
+	if( budget->motor_estimate_ma > budget->limit_ma )
+		return VMC96_ERROR_BUDGET_EXCEEDS_LIMIT;
+
+	load = vmc96_budget_refresh( budget );
+
+	/* Runs already waiting go first */
+	if( (budget->queue_count == 0) && (budget->reservation_count < VMC96_BUDGET_MAX_RESERVATIONS) && (load + budget->motor_estimate_ma <= budget->limit_ma) )
+		return vmc96_budget_admit( budget, board, row, col );
+
+	if( budget->queue_count >= VMC96_BUDGET_MAX_QUEUED_RUNS )
+		return VMC96_ERROR_BUDGET_QUEUE_FULL;
+
+	run = &budget->queue[ (budget->queue_head + budget->queue_count++) % VMC96_BUDGET_MAX_QUEUED_RUNS ];
+
+	run->vmc96 = vmc96;
+	run->row = row;
+	run->col = col;
+	run->callback = callback;
+	run->arg = arg;
+
+	return VMC96_ERROR_BUDGET_RUN_QUEUED;
+}
+
+
+int vmc96_budget_service( VMC96_budget_t * budget )
+{
+	VMC96_motor_array_status_t status;
+	vmc96_budget_run_t run;
+	unsigned int load = 0;
+	int result = VMC96_SUCCESS;
+	int ret = 0;
+	int board = 0;
+	int i = 0;
+
+	/* Refresh live current readings (updates every board run table) */
+	for( i = 0; i < budget->board_count; i++ )
+	{
+		ret = vmc96_motor_get_status( budget->board[i], &status );
+
+		if( (ret != VMC96_SUCCESS) && (result == VMC96_SUCCESS) )
+			result = ret;
+	}
+
+	load = vmc96_budget_refresh( budget );
+
+	while( (budget->queue_count > 0) && (budget->reservation_count < VMC96_BUDGET_MAX_RESERVATIONS) && (load + budget->motor_estimate_ma <= budget->limit_ma) )
+	{
+		run = budget->queue[ budget->queue_head ];
+
+		budget->queue_head = ( budget->queue_head + 1 ) % VMC96_BUDGET_MAX_QUEUED_RUNS;
+		budget->queue_count--;
+
+		board = vmc96_budget_find_board( budget, run.vmc96 );
+
+		ret = vmc96_budget_admit( budget, board, run.row, run.col );
+
+		if( ret == VMC96_SUCCESS )
+			load += budget->motor_estimate_ma;
+
+		if( run.callback )
+			run.callback( run.vmc96, run.row, run.col, ret, run.arg );
+	}
+
+	return result;
+}
+
+
+unsigned int vmc96_budget_get_load_ma( VMC96_budget_t * budget )
+{
+	return vmc96_budget_refresh( budget );
+}
+
+
+int vmc96_budget_get_queued_count( VMC96_budget_t * budget )
+{
+	return budget->queue_count;
+}
+
+
+int vmc96_budget_attach( VMC96_budget_t * budget, VMC96_t * vmc96 )
+{
+	if( vmc96_budget_find_board( budget, vmc96 ) >= 0 )
+		return VMC96_SUCCESS;
+
+	if( budget->board_count >= VMC96_BUDGET_MAX_BOARDS )
+		return VMC96_ERROR_BUDGET_TOO_MANY_BOARDS;
+
+	budget->board[ budget->board_count++ ] = vmc96;
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_budget_detach( VMC96_budget_t * budget, VMC96_t * vmc96 )
+{
+	vmc96_budget_run_t * run = NULL;
+	int board = 0;
+	int kept = 0;
+	int i = 0;
+
+	board = vmc96_budget_find_board( budget, vmc96 );
+
+	if( board < 0 )
+		return VMC96_ERROR_BUDGET_UNKNOWN_BOARD;
+
+	/* Compact the queue in place, keeping FIFO order */
+	for( i = 0; i < budget->queue_count; i++ )
+	{
+		run = &budget->queue[ (budget->queue_head + i) % VMC96_BUDGET_MAX_QUEUED_RUNS ];
+
+		if( run->vmc96 != vmc96 )
+			budget->queue[ (budget->queue_head + kept++) % VMC96_BUDGET_MAX_QUEUED_RUNS ] = *run;
+	}
+
+	budget->queue_count = kept;
+
+	/* Drop its reservations and renumber those of the boards moving down */
+	for( i = 0, kept = 0; i < budget->reservation_count; i++ )
+	{
+		if( budget->reservation[i].board == board )
+			continue;
+
+		if( budget->reservation[i].board > board )
+			budget->reservation[i].board--;
+
+		budget->reservation[ kept++ ] = budget->reservation[i];
+	}
+
+	budget->reservation_count = kept;
+
+	for( i = board; i < budget->board_count - 1; i++ )
+		budget->board[i] = budget->board[ i + 1 ];
+
+	budget->board_count--;
+
+	return VMC96_SUCCESS;
+}
+
+
+/* ********************************************************************* */
+/* *                      CONSTRUCTOR/DESTRUCTOR                       * */
+/* ********************************************************************* */
+
+void vmc96_budget_destroy( VMC96_budget_t * budget )
+{
+	free( budget );
+}
+
+
+int vmc96_budget_create( VMC96_budget_t ** ppbudget, unsigned int limit_ma, unsigned int motor_estimate_ma )
+{
+	VMC96_budget_t * budget = NULL;
+
+	budget = (VMC96_budget_t*) calloc( 1, sizeof(VMC96_budget_t) );
+
+	if( !budget )
+	{
+		*ppbudget = NULL;
+		return VMC96_ERROR_OUT_OF_MEMORY;
+	}
+
+	budget->limit_ma = limit_ma;
+	budget->motor_estimate_ma = motor_estimate_ma;
+
+	*ppbudget = budget;
+
+	return VMC96_SUCCESS;
+}
+
+/* eof */
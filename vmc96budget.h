@@ -0,0 +1,142 @@
+/*!
+	\file vmc96budget.h
+	\brief Machine-Wide Motor Current Budget across several VMC96 Boards
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#ifndef __VMC96_BUDGET_H__
+#define __VMC96_BUDGET_H__
+
+#include "vmc96api.h"
+
+
+#define VMC96_BUDGET_MAX_BOARDS                    (16)
+#define VMC96_BUDGET_MAX_QUEUED_RUNS               (64)
+#define VMC96_BUDGET_MAX_RESERVATIONS              (64)
+#define VMC96_BUDGET_RESERVATION_TIMEOUT_MS        (1000)
+
+
+typedef struct VMC96_budget_s VMC96_budget_t;
+
+
+/*!
+	\brief Called when a queued motor run is finally sent to its board.
+	\param vmc96 Board the motor belongs to.
+	\param row Motor Array Row Coordinate.
+	\param col Motor Array Column Coordinate.
+	\param result Result of vmc96_motor_run().
+	\param arg User argument given to vmc96_budget_motor_run().
+*/
+typedef void (*VMC96_budget_callback_t)( VMC96_t * vmc96, unsigned char row, unsigned char col, int result, void * arg );
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	/*!
+		\brief Create a Current Budget shared by several boards (one power supply).
+
+		The load is the sum of the last current reading of every attached board,
+		plus motor_estimate_ma for each admitted run its board has not reported yet.
+		A reservation is only dropped by a status reply, either one showing the motor
+		running or one read VMC96_BUDGET_RESERVATION_TIMEOUT_MS after the run without it.
+		Boards must be used in blocking mode, from a single thread.
+
+		\param budget Current Budget Object To be Created.
+		\param limit_ma Machine-wide current limit in milliamperes.
+		\param motor_estimate_ma Current reserved for a motor until its board reports it running.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_budget_create( VMC96_budget_t ** budget, unsigned int limit_ma, unsigned int motor_estimate_ma );
+
+	/*!
+		\brief Destroy a Current Budget (queued runs are dropped, boards are not closed).
+		\param budget Pointer to Current Budget Object.
+		\return void
+	*/
+	void vmc96_budget_destroy( VMC96_budget_t * budget );
+
+	/*!
+		\brief Attach a board to the Current Budget.
+		\param budget Pointer to Current Budget Object.
+		\param vmc96 Pointer to VMC96 Context Object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_budget_attach( VMC96_budget_t * budget, VMC96_t * vmc96 );
+
+	/*!
+		\brief Detach a board from the Current Budget (call it before vmc96_finish()).
+
+		Queued runs and reservations of the board are dropped; the callbacks of
+		its queued runs are not called.
+
+		\param budget Pointer to Current Budget Object.
+		\param vmc96 Pointer to an attached VMC96 Context Object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_budget_detach( VMC96_budget_t * budget, VMC96_t * vmc96 );
+
+	/*!
+		\brief Run a motor if it fits in the budget, queue it otherwise.
+		\param budget Pointer to Current Budget Object.
+		\param vmc96 Pointer to an attached VMC96 Context Object.
+		\param row Motor Array Row Coordinate.
+		\param col Motor Array Column Coordinate.
+		\param callback Called when a queued run is sent (may be NULL).
+		\param arg User argument passed to callback.
+		\return Returns the result of vmc96_motor_run() if the motor was run right away,
+		        or VMC96_ERROR_BUDGET_RUN_QUEUED if it was queued.
+	*/
+	int vmc96_budget_motor_run( VMC96_budget_t * budget, VMC96_t * vmc96, unsigned char row, unsigned char col, VMC96_budget_callback_t callback, void * arg );
+
+	/*!
+		\brief Refresh the status of every attached board and release queued runs that now fit.
+		\param budget Pointer to Current Budget Object.
+		\return Returns VMC96_SUCCESS, or the first status error found (other boards are still serviced).
+	*/
+	int vmc96_budget_service( VMC96_budget_t * budget );
+
+	/*!
+		\brief Retrieve the current machine-wide load estimate.
+		\param budget Pointer to Current Budget Object.
+		\return Returns the load in milliamperes.
+	*/
+	unsigned int vmc96_budget_get_load_ma( VMC96_budget_t * budget );
+
+	/*!
+		\brief Retrieve how many runs are waiting for budget.
+		\param budget Pointer to Current Budget Object.
+		\return Returns the queued runs count.
+	*/
+	int vmc96_budget_get_queued_count( VMC96_budget_t * budget );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/* eof */
@@ -92,6 +92,7 @@ struct vmc96cli_arguments_s
 	int row;
 	int col1;
 	int col2;
+	const char * device;
 };
 
 
@@ -152,19 +153,21 @@ static void vmc96cli_show_usage( void )
 	printf( "MOTOR ARRAY - GET VERSION:\n\n" );
 	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=VERSION\n\n" );
 	printf( "MOTOR ARRAY - RUN SINGLE MOTOR:\n\n" );
-	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=RUN --row=[0-11] --column=[0-7]\n\n" );
+	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=RUN --row=[0-7] --column=[0-11]\n\n" );
 	printf( "MOTOR ARRAY - RUN MOTOR PAIR:\n\n" );
-	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=RUN_PAIR --row=[0-11] --column1=[0-7] --column2=[0-7]\n\n" );
+	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=RUN_PAIR --row=[0-7] --column1=[0-11] --column2=[0-11]\n\n" );
 	printf( "MOTOR ARRAY - SCAN ARRAY:\n\n" );
 	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=SCAN\n\n" );
 	printf( "MOTOR ARRAY - GIVE PULSE:\n\n" );
-	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=GIVE_PULSE --row=[0-11] --column=[0-7] --duration=[1-255]\n\n" );
+	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=GIVE_PULSE --row=[0-7] --column=[0-11] --duration=[1-255]\n\n" );
 	printf( "MOTOR ARRAY - GET STATUS:\n\n" );
 	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=STATUS\n\n" );
 	printf( "MOTOR ARRAY - STOP ALL MOTORS:\n\n" );
 	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=STOP_ALL\n\n" );
 	printf( "MOTOR ARRAY - GET OPTO-SENSOR STATUS:\n\n" );
 	printf( "	vmc96cli --controller=MOTOR_ARRAY --command=OPTO_LINE_STATUS\n\n" );
+	printf( "USE A SERIAL TTY DEVICE (ftdi_sio) INSTEAD OF LIBFTDI:\n\n" );
+	printf( "	vmc96cli --device=/dev/ttyUSB0 --controller=[...] --command=[...]\n\n" );
 	printf( "SHOW USAGE:\n\n" );
 	printf( "	vmc96cli --help\n\n" );
 }
@@ -373,7 +376,7 @@ static int vmc96cli_execute( VMC96_t * vmc96, vmc96cli_arguments_t * args )
 				{
 					char version[ VMC96_VERSION_STRING_MAX_LEN + 1 ] = {0};
 
-					ret = vmc96_relay_get_version( vmc96, (args->controller == VMC96CLI_CONTROLLER_RELAY1) ? 0 : 1, version );
+					ret = vmc96_motor_get_version( vmc96, version );
 
 					if( ret != VMC96_SUCCESS )
 					{
@@ -614,6 +617,7 @@ static int vmc96cli_proccess_arguments( int argc, char ** argv, vmc96cli_argumen
 		{ "col2",        required_argument, 0,  'h' },
 		{ "column2",     required_argument, 0,  'h' },
 		{ "help",        no_argument,       0,  'i' },
+		{ "device",      required_argument, 0,  'j' },
 		{ NULL,          no_argument,       0,   0  }
 	};
 
@@ -625,10 +629,11 @@ static int vmc96cli_proccess_arguments( int argc, char ** argv, vmc96cli_argumen
 	args->col1 = VMC96CLI_ARGUMENT_NOT_INITIALIZED;
 	args->col2 = VMC96CLI_ARGUMENT_NOT_INITIALIZED;
 	args->duration = VMC96CLI_ARGUMENT_NOT_INITIALIZED;
+	args->device = NULL;
 
 	while(1)
 	{
-		ret = getopt_long( argc, argv, "a:b:c:d:e:f:g:h:i", options, &index );
+		ret = getopt_long( argc, argv, "a:b:c:d:e:f:g:h:ij:", options, &index );
 
 		if( ret == -1 )
 			return VMC96CLI_SUCCESS;
@@ -643,6 +648,7 @@ static int vmc96cli_proccess_arguments( int argc, char ** argv, vmc96cli_argumen
 			case 'f' : args->col = atoi( optarg ); break;
 			case 'g' : args->col1 = atoi( optarg ); break;
 			case 'h' : args->col2 = atoi( optarg ); break;
+			case 'j' : args->device = optarg; break;
 
 			case 'i' :
 				vmc96cli_show_usage();
@@ -669,7 +675,10 @@ int main( int argc, char ** argv )
 	if( ret != VMC96CLI_SUCCESS )
 		return EXIT_FAILURE;
 
-	ret = vmc96_initialize( &vmc96 );
+	if( args.device )
+		ret = vmc96_initialize_tty( &vmc96, args.device );
+	else
+		ret = vmc96_initialize( &vmc96 );
 
 	if( ret != VMC96_SUCCESS )
 	{
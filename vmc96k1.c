@@ -0,0 +1,342 @@
+/*!
+	\file vmc96k1.c
+	\brief VMC96 K1 Protocol Encoder/Decoder (transport independent)
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#include <string.h>
+
+#include "vmc96k1.h"
+
+
+/* ********************************************************************* */
+/* *                        PRIVATE PROTOTYPES                         * */
+/* ********************************************************************* */
+
+/*!
+	\brief Parse K1 Message Response Type
+	\param message
+	\return
+*/
+static int vmc96_k1_parse_response_type( const vmc96_message_t * message );
+
+
+/* ********************************************************************* */
+/* *                    MESSAGE CONTROL FUNCTIONS                      * */
+/* ********************************************************************* */
+
+unsigned char vmc96_calculate_checksum( const unsigned char * buf, size_t buflen )
+{
+	unsigned char sum = 0;
+	unsigned long i = 0;
+
+	for( i = 0; i < buflen; i++ )
+		sum ^= buf[i];
+
+	return sum;
+}
+
+
+int vmc96_prepare_k1_message( vmc96_message_t * message )
+{
+	message->k1_length = message->data_length + VMC96_K1_MESSAGE_MIN_LEN;
+
+	/* K1 Message STX Header Field */
+	message->k1[0] = VMC96_K1_MESSAGE_STX;
+
+	/* K1 Message: Controller Address/ID Field */
+	message->k1[1] = message->id_controller;
+
+	/* K1 Message: Total Length Field */
+	message->k1[2] = message->k1_length;
+
+	/* K1 Message: Command Code Field */
+	message->k1[3] = message->command;
+
+	/* K1 Message: Data Field */
+	if( message->data_length > 0 )
+		memcpy( &message->k1[4], message->data, message->data_length );
+
+	/* K1 Message: Checksum Field */
+	message->k1[ message->k1_length - 1 ] = vmc96_calculate_checksum( message->k1, message->k1_length - 1 );
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_k1_frame_complete( const unsigned char * k1, size_t len )
+{
+	/* Nothing received yet */
+	if( len == 0 )
+		return 0;
+
+	/* Not a K1 frame: stop waiting and let the parser reject it */
+	if( k1[0] != VMC96_K1_MESSAGE_STX )
+		return 1;
+
+	/* Total Length Field not received yet */
+	if( len < 3 )
+		return 0;
+
+	/* Bogus Total Length Field: let the parser reject it */
+	if( k1[2] < VMC96_K1_MESSAGE_MIN_LEN )
+		return 1;
+
+	return len >= k1[2];
+}
+
+
+static int vmc96_k1_parse_response_type( const vmc96_message_t * message )
+{
+	switch( message->id_controller )
+	{
+		case VMC96_CONTROLLER_GLOBAL_BROADCAST:
+		{
+			switch( message->command )
+			{
+				case VMC96_COMMAND_GLOBAL_RESET : return VMC96_K1_RESPONSE_TYPE_ACK;
+				default                         : return VMC96_K1_RESPONSE_TYPE_INVALID;
+			}
+		}
+
+		case VMC96_CONTROLLER_RELAY_1 :
+		case VMC96_CONTROLLER_RELAY_2 :
+		{
+			switch( message->command )
+			{
+				case VMC96_COMMAND_RESET          : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_SIMPLE_PING    : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_KERNEL_VERSION : return VMC96_K1_RESPONSE_TYPE_DATA;
+				case VMC96_COMMAND_RELAY_FUNCTION : return VMC96_K1_RESPONSE_TYPE_ACK;
+				default                           : return VMC96_K1_RESPONSE_TYPE_INVALID;
+			}
+		}
+
+		case VMC96_CONTROLLER_MOTOR_ARRAY:
+		{
+			switch( message->command )
+			{
+				case VMC96_COMMAND_RESET                  : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_SIMPLE_PING            : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_KERNEL_VERSION         : return VMC96_K1_RESPONSE_TYPE_DATA;
+				case VMC96_COMMAND_MOTOR_RUN              : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_MOTOR_STOP_ALL         : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_MOTOR_STATUS_REQUEST   : return VMC96_K1_RESPONSE_TYPE_DATA;
+				case VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS : return VMC96_K1_RESPONSE_TYPE_DATA;
+				case VMC96_COMMAND_MOTOR_GIVE_PULSE       : return VMC96_K1_RESPONSE_TYPE_ACK;
+				case VMC96_COMMAND_MOTOR_SCAN_ARRAY       : return VMC96_K1_RESPONSE_TYPE_DATA;
+				default                                   : return VMC96_K1_RESPONSE_TYPE_INVALID;
+			}
+		}
+
+		default:
+		{
+			return VMC96_K1_RESPONSE_TYPE_INVALID;
+		}
+	}
+}
+
+
+int vmc96_parse_k1_response( const vmc96_message_t * message, vmc96_message_t * response )
+{
+	switch( vmc96_k1_parse_response_type( message ) )
+	{
+		case VMC96_K1_RESPONSE_TYPE_ACK:
+		{
+			/* K1 Response: Validate Positive ACK Message Len */
+			if( response->k1_length != VMC96_K1_MESSAGE_MIN_LEN )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+
+			/* K1 Response: Parse Source Controller ID/Address Field */
+			response->id_controller = response->k1[1];
+
+			/* K1 Response: Data Field Empty */
+			response->data_length = 0;
+
+			/* K1 Response: Validating STX Header Field */
+			if( response->k1[0] != VMC96_K1_MESSAGE_STX )
+				return VMC96_ERROR_K1_RESPONSE_MALFORMED;
+
+			/* K1 Response: Validate Source Controller ID/Address Field */
+			if( response->k1[1] != message->id_controller )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
+
+			/* K1 Response: Validate Positive ACK Message Len */
+			if( response->k1[2] != VMC96_K1_MESSAGE_MIN_LEN )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+
+			/* K1 Response: Validate Checksum */
+			if( response->k1[4] != vmc96_calculate_checksum( response->k1, response->k1_length - 1 ) )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_CHECKSUM;
+
+			/* K1 Response: Validate Positive ACK Field */
+			if( response->k1[3] != VMC96_K1_RESPONSE_POSITIVE_ACK )
+				return VMC96_ERROR_K1_RESPONSE_NEGATIVE_ACK;
+
+			return VMC96_SUCCESS;
+		}
+
+		case VMC96_K1_RESPONSE_TYPE_DATA:
+		{
+			/* K1 Response: Validating Message Length */
+			if( response->k1_length < VMC96_K1_MESSAGE_MIN_LEN )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+
+			/* K1 Response: Parse Source Controller ID/Address Field */
+			response->id_controller = response->k1[1];
+
+			/* K1 Response: Validating STX Header Field */
+			if( response->k1[0] != VMC96_K1_MESSAGE_STX )
+				return VMC96_ERROR_K1_RESPONSE_MALFORMED;
+
+			/* K1 Response: Validate Source Controller ID/Address Field */
+			if( response->k1[1] != message->id_controller )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
+
+			/* K1 Response: Validate Total Length Field (before trusting it to copy data) */
+			if( response->k1[2] != response->k1_length )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+
+			/* K1 Response: Validate Checksum */
+			if( response->k1[ response->k1_length - 1 ] != vmc96_calculate_checksum( response->k1, response->k1_length - 1 ) )
+				return VMC96_ERROR_K1_RESPONSE_INVALID_CHECKSUM;
+
+			/* K1 Response: Parse Total Data Length Field */
+			response->data_length = response->k1[2] - 4;
+
+			/* K1 Response: Parse Data Field */
+			memcpy( response->data, &response->k1[3], response->data_length );
+
+			return VMC96_SUCCESS;
+		}
+
+		default:
+		{
+			return VMC96_ERROR_K1_RESPONSE_MALFORMED;
+		}
+	}
+}
+
+
+/* ********************************************************************* */
+/* *                        RESPONSE DECODERS                          * */
+/* ********************************************************************* */
+
+int vmc96_k1_decode_version( const vmc96_message_t * response, char * version )
+{
+	size_t len = 0;
+
+	if( response->data_length > 0 )
+	{
+		len = response->data_length - 1;
+
+		if( len > VMC96_VERSION_STRING_MAX_LEN )
+			len = VMC96_VERSION_STRING_MAX_LEN;
+
+		memcpy( version, response->data + 1, len );
+		version[ len ] = '\0';
+	}
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_k1_decode_motor_status( const vmc96_message_t * response, VMC96_motor_array_status_t * status )
+{
+	int i = 0;
+
+	if( response->data_length >= 2 )
+	{
+		if( response->data[0] != VMC96_COMMAND_MOTOR_STATUS_REQUEST )
+			return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
+
+		status->current_ma = VMC96_GET_MOTOR_CURRENT_MA( response->data[1] );
+
+		status->active_count = response->data_length - 2;
+
+		for( i = 0; i < response->data_length - 2; i++ )
+		{
+			unsigned char row = VMC96_GET_MOTOR_ROW( response->data[ i + 2 ] );
+			unsigned char col = VMC96_GET_MOTOR_COL( response->data[ i + 2 ] );
+
+			if( !VMC96_VALIDATE_MOTOR_COORDINATE( row, col ) )
+				return VMC96_ERROR_K1_RESPONSE_MALFORMED;
+
+			status->array.motor[ row ][ col ] = 1;
+		}
+	}
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_k1_decode_opto_line_status( const vmc96_message_t * response, VMC96_opto_line_sample_block_t * status_block )
+{
+	int i = 0;
+	int j = 0;
+	int k = 0;
+
+	if( response->data_length < 5 )
+		return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+
+	for( i = 0; i < 4; i++ )
+	{
+		for( j = 0; j < 8; j++ )
+		{
+			status_block->sample[ k++ ] = (response->data[ i + 1 ] >> j) & 0x01;
+		}
+	}
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_k1_decode_scan_array( const vmc96_message_t * response, VMC96_motor_array_scan_result_t * result )
+{
+	unsigned char row = 0;
+	unsigned char col = 0;
+
+	if( response->data_length < 1 )
+		return VMC96_ERROR_K1_RESPONSE_INVALID_LENGTH;
+
+	if( response->data[0] != VMC96_COMMAND_MOTOR_SCAN_ARRAY )
+		return VMC96_ERROR_K1_RESPONSE_INVALID_SOURCE;
+
+	/* Columns missing from a short response are reported as empty */
+	for( col = 0; (col < VMC96_MOTOR_ARRAY_COLUMNS_COUNT) && (col + 1 < response->data_length); col++ )
+	{
+		for( row = 0; row < VMC96_MOTOR_ARRAY_ROWS_COUNT; row++ )
+		{
+			result->array.motor[ row ][ col ] = ( response->data[ 1 + col ] >> row ) & 0x1;
+
+			if( result->array.motor[ row ][ col ] )
+				result->count++;
+		}
+	}
+
+	return VMC96_SUCCESS;
+}
+
+/* eof */
@@ -0,0 +1,176 @@
+/*!
+	\file vmc96k1.h
+	\brief VMC96 K1 Protocol Encoder/Decoder (transport independent)
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+
+#ifndef __VMC96_K1_H__
+#define __VMC96_K1_H__
+
+#include <stddef.h>
+
+#include "vmc96api.h"
+
+
+/* K1 PROTOCOL SPECIFICS */
+#define VMC96_K1_MESSAGE_STX                              (0x35)
+#define VMC96_K1_MESSAGE_MAX_LEN                          (255)
+#define VMC96_K1_MESSAGE_MIN_LEN                          (5)
+#define VMC96_K1_MESSAGE_DATA_MAX_LEN                     (250)
+#define VMC96_K1_RESPONSE_POSITIVE_ACK                    (0x00)
+
+/* K1 PROTOCOL REPONSE TYPES */
+#define VMC96_K1_RESPONSE_TYPE_INVALID                    (-1)
+#define VMC96_K1_RESPONSE_TYPE_ACK                        (1)
+#define VMC96_K1_RESPONSE_TYPE_DATA                       (2)
+
+/* DEVICE */
+#define VMC96_MOTOR_MAX_CURRENT_READING_MA                (500)
+
+/* VMC96 AVAILABLE CONTROLLERS */
+#define VMC96_CONTROLLER_GLOBAL_BROADCAST                 (0x00)
+#define VMC96_CONTROLLER_RELAY_BASE_ADDRESS               (0x26)
+#define VMC96_CONTROLLER_RELAY_1                          (0x26)
+#define VMC96_CONTROLLER_RELAY_2                          (0x27)
+#define VMC96_CONTROLLER_MOTOR_ARRAY                      (0x30)
+
+/* VMC96 GLOBAL COMMANDS */
+#define VMC96_COMMAND_SIMPLE_PING                         (0x00)
+#define VMC96_COMMAND_GLOBAL_RESET                        (0x01)
+#define VMC96_COMMAND_KERNEL_VERSION                      (0x02)
+#define VMC96_COMMAND_RESET                               (0x05)
+
+/* VMC96 MOTOR ARRAY COMMANDS */
+#define VMC96_COMMAND_MOTOR_RESET                         (0x05)
+#define VMC96_COMMAND_MOTOR_STATUS_REQUEST                (0x10)
+#define VMC96_COMMAND_MOTOR_SCAN_ARRAY                    (0x11)
+#define VMC96_COMMAND_MOTOR_STOP_ALL                      (0x12)
+#define VMC96_COMMAND_MOTOR_RUN                           (0x13)
+#define VMC96_COMMAND_MOTOR_GIVE_PULSE                    (0x14)
+#define VMC96_COMMAND_MOTOR_OPTO_LINE_STATUS              (0x15)
+
+/* VMC96 GENERAL PURPOSE RELAYS COMMANDS */
+#define VMC96_COMMAND_RELAY_FUNCTION                      (0x11)
+
+/* HELPERS */
+#define VMC96_GET_MOTOR_ID( _row, _col )                  (((_row + 1) << 4) + (_col + 1))
+#define VMC96_GET_MOTOR_ROW( _mid )                       ( ( (_mid & 0xF0) >> 4 ) - 1 )
+#define VMC96_GET_MOTOR_COL( _mid )                       ( ( _mid & 0x0F ) - 1 )
+#define VMC96_GET_MOTOR_CURRENT_MA( _val )                (( VMC96_MOTOR_MAX_CURRENT_READING_MA * _val) / 255 )
+#define VMC96_VALIDATE_MOTOR_COORDINATE( _row, _col )     ((_row < VMC96_MOTOR_ARRAY_ROWS_COUNT) && (_col < VMC96_MOTOR_ARRAY_COLUMNS_COUNT))
+
+
+typedef struct vmc96_message_s vmc96_message_t;
+
+
+/*!
+	\brief Represents a K1 Message (request or response)
+*/
+struct vmc96_message_s
+{
+	unsigned char id_controller;                           /*!< Controller Address/ID */
+	unsigned char command;                                 /*!< Command Code */
+	unsigned char data[ VMC96_K1_MESSAGE_DATA_MAX_LEN ];   /*!< Data Field */
+	unsigned char data_length;                             /*!< Data Field Length */
+	unsigned char k1[ VMC96_K1_MESSAGE_MAX_LEN ];          /*!< Raw K1 Frame */
+	unsigned char k1_length;                               /*!< Raw K1 Frame Length */
+};
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	/*!
+		\brief Calculate K1 Message Checksum
+		\param buf Buffer.
+		\param buflen Buffer length.
+		\return Returns the XOR of all bytes.
+	*/
+	unsigned char vmc96_calculate_checksum( const unsigned char * buf, size_t buflen );
+
+	/*!
+		\brief Encode the raw K1 frame of a message from its controller, command and data fields.
+		\param message K1 Message.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_prepare_k1_message( vmc96_message_t * message );
+
+	/*!
+		\brief Check if a (possibly partial) raw K1 frame has been completely received.
+		\param k1 Received bytes.
+		\param len Received bytes count.
+		\return Returns non-zero when no more bytes are needed to parse it.
+	*/
+	int vmc96_k1_frame_complete( const unsigned char * k1, size_t len );
+
+	/*!
+		\brief Validate the raw K1 frame of a response and parse its fields.
+		\param message K1 Message the response answers to.
+		\param response K1 Response.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_parse_k1_response( const vmc96_message_t * message, vmc96_message_t * response );
+
+	/*!
+		\brief Decode a Kernel Version response.
+		\param response Parsed K1 Response.
+		\param version Buffer to store version string (VMC96_VERSION_STRING_MAX_LEN + 1 bytes).
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_k1_decode_version( const vmc96_message_t * response, char * version );
+
+	/*!
+		\brief Decode a Motor Array Status response.
+		\param response Parsed K1 Response.
+		\param status Zero initialized status object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_k1_decode_motor_status( const vmc96_message_t * response, VMC96_motor_array_status_t * status );
+
+	/*!
+		\brief Decode an Opto Line Status response.
+		\param response Parsed K1 Response.
+		\param status_block Sample block.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_k1_decode_opto_line_status( const vmc96_message_t * response, VMC96_opto_line_sample_block_t * status_block );
+
+	/*!
+		\brief Decode a Motor Array Scan response.
+		\param response Parsed K1 Response.
+		\param result Zero initialized scan result object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_k1_decode_scan_array( const vmc96_message_t * response, VMC96_motor_array_scan_result_t * result );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/* eof */
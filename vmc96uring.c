@@ -0,0 +1,797 @@
+/*!
+	\file vmc96uring.c
+	\brief io_uring Transport driving several VMC96 TTY Boards from one Thread
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <termios.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "vmc96api.h"
+#include "vmc96uring.h"
+
+
+#ifdef __linux__
+
+/* ********************************************************************* */
+/* *                              DEFINES                              * */
+/* ********************************************************************* */
+
+/* Write, read, linked timeout and cancel per board at most */
+#define VMC96_URING_QUEUE_DEPTH                           (VMC96_URING_MAX_BOARDS * 4)
+#define VMC96_URING_RX_BUFFER_LEN                         (256)
+#define VMC96_URING_CANCEL_TIMEOUT_MS                     (1000)
+
+/* OPERATION KINDS (low bits of user_data, board slot above) */
+#define VMC96_URING_OP_WRITE                              (1)
+#define VMC96_URING_OP_READ                               (2)
+#define VMC96_URING_OP_TIMEOUT                            (3)
+#define VMC96_URING_OP_CANCEL                             (4)
+
+#define VMC96_URING_USER_DATA( _slot, _op )               ( ((__u64) (_slot) << 3) | (_op) )
+#define VMC96_URING_USER_DATA_SLOT( _ud )                 ( (int) ((_ud) >> 3) )
+#define VMC96_URING_USER_DATA_OP( _ud )                   ( (int) ((_ud) & 7) )
+
+
+/* ********************************************************************* */
+/* *                        STRUCTS AND DATA TYPES                     * */
+/* ********************************************************************* */
+
+typedef struct vmc96_uring_board_s vmc96_uring_board_t;
+
+
+struct vmc96_uring_board_s
+{
+	VMC96_t * vmc96;
+	int fd;
+	int inflight;
+	int error;
+	int write_cancelled;
+	const unsigned char * frame;
+	size_t length;
+	size_t written;
+	struct __kernel_timespec deadline;
+	struct termios tio;
+	unsigned char rx[ VMC96_URING_RX_BUFFER_LEN ];
+};
+
+
+struct VMC96_uring_s
+{
+	int fd;
+
+	void * sq_ring;
+	size_t sq_ring_size;
+	unsigned int * sq_head;
+	unsigned int * sq_tail;
+	unsigned int * sq_mask;
+	unsigned int * sq_array;
+	unsigned int sq_entries;
+	unsigned int sq_local_tail;
+
+	struct io_uring_sqe * sqes;
+	size_t sqes_size;
+
+	void * cq_ring;
+	size_t cq_ring_size;
+	unsigned int * cq_head;
+	unsigned int * cq_tail;
+	unsigned int * cq_mask;
+	struct io_uring_cqe * cqes;
+
+	unsigned long enter_count;
+	int inflight;
+
+	vmc96_uring_board_t board[ VMC96_URING_MAX_BOARDS ];
+};
+
+
+/* ********************************************************************* */
+/* *                        PRIVATE PROTOTYPES                         * */
+/* ********************************************************************* */
+
+/*!
+	\brief Create the Ring and Map its Queues
+	\param ring
+	\return
+*/
+static int vmc96_uring_setup( VMC96_uring_t * ring );
+
+/*!
+	\brief Submit Queued SQEs and Optionally Wait for Completions
+	\param ring
+	\param wait
+	\param timeout_ms
+	\return
+*/
+static int vmc96_uring_enter( VMC96_uring_t * ring, int wait, int timeout_ms );
+
+/*!
+	\brief Queue an SQE for a Board
+	\param ring
+	\param slot
+	\param op
+	\return
+*/
+static struct io_uring_sqe * vmc96_uring_get_sqe( VMC96_uring_t * ring, int slot, int op );
+
+/*!
+	\brief Send the Pending Request of an Idle Board
+	\param ring
+	\param slot
+	\return
+*/
+static void vmc96_uring_start_board( VMC96_uring_t * ring, int slot );
+
+/*!
+	\brief Queue the Unwritten Part of the Request
+	\param ring
+	\param slot
+	\return
+*/
+static int vmc96_uring_queue_write( VMC96_uring_t * ring, int slot );
+
+/*!
+	\brief Queue a Response Read Linked to the Transaction Deadline
+	\param ring
+	\param slot
+	\return
+*/
+static int vmc96_uring_queue_read( VMC96_uring_t * ring, int slot );
+
+/*!
+	\brief Queue the Cancellation of a Board Operation
+	\param ring
+	\param slot
+	\param op
+	\return
+*/
+static void vmc96_uring_queue_cancel( VMC96_uring_t * ring, int slot, int op );
+
+/*!
+	\brief Hand a Finished Read to the Board Context
+	\param ring
+	\param slot
+	\param res
+	\param completions
+	\param count
+	\return
+*/
+static void vmc96_uring_complete_read( VMC96_uring_t * ring, int slot, int res, VMC96_uring_completion_t * completions, int * count );
+
+/*!
+	\brief Process CQEs until the Queue is Empty or max Transactions Finished
+	\param ring
+	\param completions
+	\param max
+	\param count
+	\return
+*/
+static void vmc96_uring_reap( VMC96_uring_t * ring, VMC96_uring_completion_t * completions, int max, int * count );
+
+
+/* ********************************************************************* */
+/* *                          IMPLEMENTATION                           * */
+/* ********************************************************************* */
+
+static int vmc96_uring_setup( VMC96_uring_t * ring )
+{
+	struct io_uring_params params;
+	void * ptr = NULL;
+
+	memset( &params, 0, sizeof(params) );
+
+	ring->fd = (int) syscall( __NR_io_uring_setup, VMC96_URING_QUEUE_DEPTH, &params );
+
+	if( ring->fd < 0 )
+		return VMC96_ERROR_URING_SETUP;
+
+	/* Waiting with a timeout needs IORING_ENTER_EXT_ARG (Linux 5.11) */
+	if( !(params.features & IORING_FEAT_EXT_ARG) )
+		return VMC96_ERROR_URING_SETUP;
+
+	ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	if( params.features & IORING_FEAT_SINGLE_MMAP )
+	{
+		if( ring->cq_ring_size > ring->sq_ring_size )
+			ring->sq_ring_size = ring->cq_ring_size;
+
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+
+	ptr = mmap( NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING );
+
+	if( ptr == MAP_FAILED )
+		return VMC96_ERROR_URING_SETUP;
+
+	ring->sq_ring = ptr;
+
+	if( params.features & IORING_FEAT_SINGLE_MMAP )
+	{
+		ring->cq_ring = ring->sq_ring;
+	}
+	else
+	{
+		ptr = mmap( NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING );
+
+		if( ptr == MAP_FAILED )
+			return VMC96_ERROR_URING_SETUP;
+
+		ring->cq_ring = ptr;
+	}
+
+	ptr = mmap( NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES );
+
+	if( ptr == MAP_FAILED )
+		return VMC96_ERROR_URING_SETUP;
+
+	ring->sqes = (struct io_uring_sqe *) ptr;
+
+	ring->sq_head = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.head);
+	ring->sq_tail = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.tail);
+	ring->sq_mask = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.array);
+	ring->sq_entries = params.sq_entries;
+	ring->sq_local_tail = *ring->sq_tail;
+
+	ring->cq_head = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.head);
+	ring->cq_tail = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.tail);
+	ring->cq_mask = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params.cq_off.cqes);
+
+	return VMC96_SUCCESS;
+}
+
+
+static int vmc96_uring_enter( VMC96_uring_t * ring, int wait, int timeout_ms )
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	unsigned int submit = 0;
+	unsigned int flags = 0;
+	long ret = 0;
+
+	__atomic_store_n( ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE );
+
+	submit = ring->sq_local_tail - __atomic_load_n( ring->sq_head, __ATOMIC_ACQUIRE );
+
+	if( !submit && !wait )
+		return VMC96_SUCCESS;
+
+	memset( &arg, 0, sizeof(arg) );
+
+	if( wait )
+	{
+		flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+
+		if( timeout_ms >= 0 )
+		{
+			ts.tv_sec = timeout_ms / 1000;
+			ts.tv_nsec = (long long) (timeout_ms % 1000) * 1000000LL;
+			arg.ts = (__u64) (uintptr_t) &ts;
+		}
+	}
+
+	ring->enter_count++;
+
+	ret = syscall( __NR_io_uring_enter, ring->fd, submit, ( wait ) ? 1 : 0, flags, &arg, sizeof(arg) );
+
+	/* Timeouts, signals and a full completion queue are retried by the caller */
+	if( (ret < 0) && (errno != ETIME) && (errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY) )
+		return VMC96_ERROR_URING_SUBMIT;
+
+	return VMC96_SUCCESS;
+}
+
+
+static struct io_uring_sqe * vmc96_uring_get_sqe( VMC96_uring_t * ring, int slot, int op )
+{
+	struct io_uring_sqe * sqe = NULL;
+	unsigned int index = 0;
+
+	if( ring->sq_local_tail - __atomic_load_n( ring->sq_head, __ATOMIC_ACQUIRE ) >= ring->sq_entries )
+		return NULL;
+
+	index = ring->sq_local_tail & *ring->sq_mask;
+
+	sqe = &ring->sqes[ index ];
+	memset( sqe, 0, sizeof(struct io_uring_sqe) );
+	sqe->user_data = VMC96_URING_USER_DATA( slot, op );
+
+	ring->sq_array[ index ] = index;
+	ring->sq_local_tail++;
+
+	ring->board[ slot ].inflight++;
+	ring->inflight++;
+
+	return sqe;
+}
+
+
+static int vmc96_uring_queue_write( VMC96_uring_t * ring, int slot )
+{
+	vmc96_uring_board_t * board = &ring->board[ slot ];
+	struct io_uring_sqe * sqe = vmc96_uring_get_sqe( ring, slot, VMC96_URING_OP_WRITE );
+
+	if( !sqe )
+		return VMC96_ERROR_URING_SUBMIT;
+
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->fd = board->fd;
+	sqe->addr = (__u64) (uintptr_t) (board->frame + board->written);
+	sqe->len = (__u32) (board->length - board->written);
+	sqe->off = (__u64) -1;
+
+	return VMC96_SUCCESS;
+}
+
+
+static int vmc96_uring_queue_read( VMC96_uring_t * ring, int slot )
+{
+	vmc96_uring_board_t * board = &ring->board[ slot ];
+	struct io_uring_sqe * sqe = NULL;
+
+	if( ring->sq_local_tail - __atomic_load_n( ring->sq_head, __ATOMIC_ACQUIRE ) + 2 > ring->sq_entries )
+		return VMC96_ERROR_URING_SUBMIT;
+
+	sqe = vmc96_uring_get_sqe( ring, slot, VMC96_URING_OP_READ );
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = board->fd;
+	sqe->addr = (__u64) (uintptr_t) board->rx;
+	sqe->len = VMC96_URING_RX_BUFFER_LEN;
+	sqe->off = (__u64) -1;
+	sqe->flags = IOSQE_IO_LINK;
+
+	/* Absolute, so reads resumed after a partial frame keep the same deadline */
+	sqe = vmc96_uring_get_sqe( ring, slot, VMC96_URING_OP_TIMEOUT );
+	sqe->opcode = IORING_OP_LINK_TIMEOUT;
+	sqe->fd = -1;
+	sqe->addr = (__u64) (uintptr_t) &board->deadline;
+	sqe->len = 1;
+	sqe->timeout_flags = IORING_TIMEOUT_ABS;
+
+	return VMC96_SUCCESS;
+}
+
+
+static void vmc96_uring_queue_cancel( VMC96_uring_t * ring, int slot, int op )
+{
+	struct io_uring_sqe * sqe = vmc96_uring_get_sqe( ring, slot, VMC96_URING_OP_CANCEL );
+
+	/* Without room a read still ends on its deadline */
+	if( !sqe )
+		return;
+
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = VMC96_URING_USER_DATA( slot, op );
+}
+
+
+static void vmc96_uring_start_board( VMC96_uring_t * ring, int slot )
+{
+	vmc96_uring_board_t * board = &ring->board[ slot ];
+	unsigned long deadline_ms = 0;
+
+	if( !board->vmc96 || board->inflight )
+		return;
+
+	/* Write, read and linked timeout go together */
+	if( ring->sq_local_tail - __atomic_load_n( ring->sq_head, __ATOMIC_ACQUIRE ) + 3 > ring->sq_entries )
+		return;
+
+	board->length = vmc96_get_request_frame( board->vmc96, &board->frame );
+
+	if( !board->length )
+		return;
+
+	board->written = 0;
+	board->error = VMC96_SUCCESS;
+	board->write_cancelled = 0;
+
+	/* vmc96_get_time_ms() and io_uring absolute timeouts both use CLOCK_MONOTONIC */
+	deadline_ms = vmc96_get_deadline_ms( board->vmc96 );
+	board->deadline.tv_sec = (long long) (deadline_ms / 1000UL);
+	board->deadline.tv_nsec = (long long) (deadline_ms % 1000UL) * 1000000LL;
+
+	vmc96_uring_queue_write( ring, slot );
+	vmc96_uring_queue_read( ring, slot );
+}
+
+
+static void vmc96_uring_complete_read( VMC96_uring_t * ring, int slot, int res, VMC96_uring_completion_t * completions, int * count )
+{
+	vmc96_uring_board_t * board = &ring->board[ slot ];
+	int ret = 0;
+
+	/* A request the TTY never took must not hold the board (a hung up TTY fails it by itself) */
+	if( (res == -ECANCELED) && (board->written < board->length) && !board->write_cancelled )
+	{
+		board->write_cancelled = 1;
+		vmc96_uring_queue_cancel( ring, slot, VMC96_URING_OP_WRITE );
+	}
+
+	if( res > 0 )
+	{
+		ret = vmc96_deliver_response( board->vmc96, board->rx, (size_t) res );
+	}
+	else if( board->error != VMC96_SUCCESS )
+	{
+		ret = vmc96_abort_transaction( board->vmc96, board->error );
+	}
+	else
+	{
+		/* Cancelled by the linked timeout; nothing read at all means a hung up TTY */
+		ret = vmc96_abort_transaction( board->vmc96, ( res == -ECANCELED ) ? VMC96_ERROR_K1_RESPONSE_TIMEOUT : VMC96_ERROR_TTY_READ_DATA );
+	}
+
+	/* Requests are not flushed under io_uring: drop what is left of a failed exchange */
+	if( (ret != VMC96_SUCCESS) && (ret != VMC96_ERROR_K1_RESPONSE_PENDING) )
+		tcflush( board->fd, TCIFLUSH );
+
+	if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+	{
+		/* A follow-up request (vmc96_motor_prepare()) is sent once this one has fully settled */
+		if( vmc96_write_pending( board->vmc96 ) )
+			return;
+
+		/* Rest of the frame */
+		if( vmc96_uring_queue_read( ring, slot ) == VMC96_SUCCESS )
+			return;
+
+		ret = vmc96_abort_transaction( board->vmc96, VMC96_ERROR_URING_SUBMIT );
+
+		if( ret == VMC96_ERROR_K1_RESPONSE_PENDING )
+			return;
+	}
+
+	completions[ *count ].vmc96 = board->vmc96;
+	completions[ *count ].result = ret;
+	(*count)++;
+}
+
+
+static void vmc96_uring_reap( VMC96_uring_t * ring, VMC96_uring_completion_t * completions, int max, int * count )
+{
+	struct io_uring_cqe * cqe = NULL;
+	vmc96_uring_board_t * board = NULL;
+	unsigned int head = *ring->cq_head;
+	int slot = 0;
+	int res = 0;
+
+	while( (head != __atomic_load_n( ring->cq_tail, __ATOMIC_ACQUIRE )) && (*count < max) )
+	{
+		cqe = &ring->cqes[ head & *ring->cq_mask ];
+		slot = VMC96_URING_USER_DATA_SLOT( cqe->user_data );
+		res = cqe->res;
+
+		board = &ring->board[ slot ];
+		board->inflight--;
+		ring->inflight--;
+
+		switch( VMC96_URING_USER_DATA_OP( cqe->user_data ) )
+		{
+			case VMC96_URING_OP_WRITE :
+
+				if( board->write_cancelled )
+					break;
+
+				/* Cancelling another board's write signals the shared io-wq worker */
+				if( (res == -EINTR) && (vmc96_uring_queue_write( ring, slot ) == VMC96_SUCCESS) )
+					break;
+
+				if( res < 0 )
+				{
+					board->error = VMC96_ERROR_TTY_WRITE_DATA;
+					vmc96_uring_queue_cancel( ring, slot, VMC96_URING_OP_READ );
+					break;
+				}
+
+				board->written += res;
+
+				if( (board->written < board->length) && (vmc96_uring_queue_write( ring, slot ) != VMC96_SUCCESS) )
+				{
+					board->error = VMC96_ERROR_URING_SUBMIT;
+					vmc96_uring_queue_cancel( ring, slot, VMC96_URING_OP_READ );
+				}
+
+				break;
+
+			case VMC96_URING_OP_READ :
+
+				vmc96_uring_complete_read( ring, slot, res, completions, count );
+				break;
+
+			default :
+				break;
+		}
+
+		head++;
+		__atomic_store_n( ring->cq_head, head, __ATOMIC_RELEASE );
+	}
+}
+
+
+int vmc96_uring_wait( VMC96_uring_t * ring, VMC96_uring_completion_t * completions, int max, int * count, int timeout_ms )
+{
+	unsigned long deadline_ms = vmc96_get_time_ms() + (unsigned long) timeout_ms;
+	long remaining = timeout_ms;
+	int ready = 0;
+	int ret = 0;
+	int i = 0;
+
+	*count = 0;
+
+	while( 1 )
+	{
+		for( i = 0; i < VMC96_URING_MAX_BOARDS; i++ )
+			vmc96_uring_start_board( ring, i );
+
+		ready = ( *ring->cq_head != __atomic_load_n( ring->cq_tail, __ATOMIC_ACQUIRE ) );
+
+		/* Nothing in flight: there is nothing to wait for */
+		if( !ring->inflight && !ready )
+			return VMC96_SUCCESS;
+
+		ret = vmc96_uring_enter( ring, !ready && (remaining != 0), (int) remaining );
+
+		if( ret != VMC96_SUCCESS )
+			return ret;
+
+		vmc96_uring_reap( ring, completions, max, count );
+
+		if( (*count > 0) || (remaining == 0) )
+			return VMC96_SUCCESS;
+
+		if( timeout_ms > 0 )
+		{
+			remaining = (long) (deadline_ms - vmc96_get_time_ms());
+
+			if( remaining <= 0 )
+				return VMC96_SUCCESS;
+		}
+	}
+}
+
+
+unsigned long vmc96_uring_get_enter_count( VMC96_uring_t * ring )
+{
+	return ring->enter_count;
+}
+
+
+int vmc96_uring_attach( VMC96_uring_t * ring, VMC96_t * vmc96 )
+{
+	struct termios tio;
+	int ret = 0;
+	int i = 0;
+
+	for( i = 0; i < VMC96_URING_MAX_BOARDS; i++ )
+		if( !ring->board[i].vmc96 )
+			break;
+
+	if( i == VMC96_URING_MAX_BOARDS )
+		return VMC96_ERROR_URING_TOO_MANY_BOARDS;
+
+	ret = vmc96_set_external_io( vmc96, 1 );
+
+	if( ret != VMC96_SUCCESS )
+		return ret;
+
+	memset( &ring->board[i], 0, sizeof(vmc96_uring_board_t) );
+	ring->board[i].fd = vmc96_get_fd( vmc96 );
+
+	/* With VMIN=0 an empty TTY reads as end of file instead of arming a poll */
+	if( tcgetattr( ring->board[i].fd, &ring->board[i].tio ) < 0 )
+	{
+		vmc96_set_external_io( vmc96, 0 );
+		return VMC96_ERROR_TTY_SET_ATTRIBUTES;
+	}
+
+	memcpy( &tio, &ring->board[i].tio, sizeof(struct termios) );
+	tio.c_cc[ VMIN ] = 1;
+
+	if( tcsetattr( ring->board[i].fd, TCSANOW, &tio ) < 0 )
+	{
+		vmc96_set_external_io( vmc96, 0 );
+		return VMC96_ERROR_TTY_SET_ATTRIBUTES;
+	}
+
+	/* Requests are no longer flushed one by one */
+	tcflush( ring->board[i].fd, TCIOFLUSH );
+
+	ring->board[i].vmc96 = vmc96;
+
+	return VMC96_SUCCESS;
+}
+
+
+int vmc96_uring_detach( VMC96_uring_t * ring, VMC96_t * vmc96 )
+{
+	int ret = 0;
+	int i = 0;
+
+	for( i = 0; i < VMC96_URING_MAX_BOARDS; i++ )
+		if( ring->board[i].vmc96 == vmc96 )
+			break;
+
+	if( i == VMC96_URING_MAX_BOARDS )
+		return VMC96_ERROR_URING_UNKNOWN_BOARD;
+
+	if( ring->board[i].inflight )
+		return VMC96_ERROR_K1_TRANSACTION_BUSY;
+
+	ret = vmc96_set_external_io( vmc96, 0 );
+
+	if( ret != VMC96_SUCCESS )
+		return ret;
+
+	tcsetattr( ring->board[i].fd, TCSANOW, &ring->board[i].tio );
+
+	ring->board[i].vmc96 = NULL;
+
+	return VMC96_SUCCESS;
+}
+
+
+void vmc96_uring_destroy( VMC96_uring_t * ring )
+{
+	unsigned long deadline_ms = vmc96_get_time_ms() + VMC96_URING_CANCEL_TIMEOUT_MS;
+	VMC96_t * vmc96 = NULL;
+	int i = 0;
+
+	if( !ring )
+		return;
+
+	if( ring->sqes )
+	{
+		/* The kernel must be done with the buffers before they are freed */
+		for( i = 0; i < VMC96_URING_MAX_BOARDS; i++ )
+			if( ring->board[i].inflight )
+			{
+				vmc96_uring_queue_cancel( ring, i, VMC96_URING_OP_READ );
+				vmc96_uring_queue_cancel( ring, i, VMC96_URING_OP_WRITE );
+			}
+
+		while( ring->inflight && ((long) (deadline_ms - vmc96_get_time_ms()) > 0) )
+		{
+			if( vmc96_uring_enter( ring, 1, VMC96_URING_CANCEL_TIMEOUT_MS ) != VMC96_SUCCESS )
+				break;
+
+			while( *ring->cq_head != __atomic_load_n( ring->cq_tail, __ATOMIC_ACQUIRE ) )
+			{
+				i = VMC96_URING_USER_DATA_SLOT( ring->cqes[ *ring->cq_head & *ring->cq_mask ].user_data );
+				ring->board[i].inflight--;
+				ring->inflight--;
+				__atomic_store_n( ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE );
+			}
+		}
+	}
+
+	for( i = 0; i < VMC96_URING_MAX_BOARDS; i++ )
+	{
+		vmc96 = ring->board[i].vmc96;
+
+		if( !vmc96 )
+			continue;
+
+		/* Failed steps of vmc96_motor_prepare() may queue more requests */
+		while( vmc96_abort_transaction( vmc96, VMC96_ERROR_TTY_READ_DATA ) == VMC96_ERROR_K1_RESPONSE_PENDING );
+
+		vmc96_set_external_io( vmc96, 0 );
+
+		tcsetattr( ring->board[i].fd, TCSANOW, &ring->board[i].tio );
+	}
+
+	if( ring->sqes )
+		munmap( ring->sqes, ring->sqes_size );
+
+	if( ring->cq_ring && (ring->cq_ring != ring->sq_ring) )
+		munmap( ring->cq_ring, ring->cq_ring_size );
+
+	if( ring->sq_ring )
+		munmap( ring->sq_ring, ring->sq_ring_size );
+
+	if( ring->fd >= 0 )
+		close( ring->fd );
+
+	free( ring );
+}
+
+
+int vmc96_uring_create( VMC96_uring_t ** ppring )
+{
+	VMC96_uring_t * ring = (VMC96_uring_t *) calloc( 1, sizeof(VMC96_uring_t) );
+	int ret = 0;
+
+	if( !ring )
+		return VMC96_ERROR_OUT_OF_MEMORY;
+
+	ret = vmc96_uring_setup( ring );
+
+	if( ret != VMC96_SUCCESS )
+	{
+		vmc96_uring_destroy( ring );
+		return ret;
+	}
+
+	*ppring = ring;
+
+	return VMC96_SUCCESS;
+}
+
+#else
+
+/* io_uring is Linux only */
+
+int vmc96_uring_create( VMC96_uring_t ** ppring )
+{
+	return VMC96_ERROR_URING_SETUP;
+}
+
+
+void vmc96_uring_destroy( VMC96_uring_t * ring )
+{
+}
+
+
+int vmc96_uring_attach( VMC96_uring_t * ring, VMC96_t * vmc96 )
+{
+	return VMC96_ERROR_URING_SETUP;
+}
+
+
+int vmc96_uring_detach( VMC96_uring_t * ring, VMC96_t * vmc96 )
+{
+	return VMC96_ERROR_URING_UNKNOWN_BOARD;
+}
+
+
+int vmc96_uring_wait( VMC96_uring_t * ring, VMC96_uring_completion_t * completions, int max, int * count, int timeout_ms )
+{
+	return VMC96_ERROR_URING_SETUP;
+}
+
+
+unsigned long vmc96_uring_get_enter_count( VMC96_uring_t * ring )
+{
+	return 0;
+}
+
+#endif
+
+/* eof */
@@ -0,0 +1,124 @@
+/*!
+	\file vmc96uring.h
+	\brief io_uring Transport driving several VMC96 TTY Boards from one Thread
+	\author Tiago Ventura (tiago.ventura@gmail.com)
+	\date Oct.2026
+
+	Copyright (c) 2018 Tiago Ventura (tiago.ventura@gmail.com)
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+
+#ifndef __VMC96_URING_H__
+#define __VMC96_URING_H__
+
+#include "vmc96api.h"
+
+
+#define VMC96_URING_MAX_BOARDS                     (64)
+
+
+typedef struct VMC96_uring_s VMC96_uring_t;
+
+typedef struct VMC96_uring_completion_s VMC96_uring_completion_t;
+
+
+/*!
+	\brief Transaction completed by vmc96_uring_wait().
+*/
+struct VMC96_uring_completion_s
+{
+	VMC96_t * vmc96;      /*!< Board the transaction belongs to */
+	int result;           /*!< Result of the command */
+};
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	/*!
+		\brief Create an io_uring Transport (Linux 5.11 or newer, no liburing needed).
+
+		Every attached TTY board is served by the same ring: a request is one write
+		plus one read linked to an IORING_OP_LINK_TIMEOUT that expires on the
+		transaction deadline (VMC96_K1_RESPONSE_TIMEOUT_MS after the request), and
+		the requests of all boards are submitted and reaped by a single
+		io_uring_enter() per vmc96_uring_wait() call. Single thread only.
+
+		\param ring io_uring Transport Object To be Created.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_uring_create( VMC96_uring_t ** ring );
+
+	/*!
+		\brief Destroy an io_uring Transport (pending transactions fail, boards are not closed).
+		\param ring Pointer to io_uring Transport Object.
+		\return void
+	*/
+	void vmc96_uring_destroy( VMC96_uring_t * ring );
+
+	/*!
+		\brief Attach an idle TTY board; its commands then return VMC96_ERROR_K1_RESPONSE_PENDING
+		       and complete through vmc96_uring_wait() (see vmc96_set_external_io()).
+		\param ring Pointer to io_uring Transport Object.
+		\param vmc96 Pointer to a TTY VMC96 Context Object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_uring_attach( VMC96_uring_t * ring, VMC96_t * vmc96 );
+
+	/*!
+		\brief Detach an idle board (call it before vmc96_finish()).
+		\param ring Pointer to io_uring Transport Object.
+		\param vmc96 Pointer to an attached VMC96 Context Object.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_uring_detach( VMC96_uring_t * ring, VMC96_t * vmc96 );
+
+	/*!
+		\brief Submit the requests issued since the last call and wait for transactions to complete.
+
+		Responses split over several reads, timeouts and the follow-up requests of
+		vmc96_motor_prepare() are handled internally; only finished commands are
+		reported.
+
+		\param ring Pointer to io_uring Transport Object.
+		\param completions Receives the finished transactions.
+		\param max Size of the completions array.
+		\param count Receives the number of finished transactions (0 on timeout).
+		\param timeout_ms Maximum wait, 0 to only submit and reap, -1 to wait until one finishes.
+		\return Returns VMC96_SUCCESS in case of success.
+	*/
+	int vmc96_uring_wait( VMC96_uring_t * ring, VMC96_uring_completion_t * completions, int max, int * count, int timeout_ms );
+
+	/*!
+		\brief Retrieve how many io_uring_enter() system calls the transport made.
+		\param ring Pointer to io_uring Transport Object.
+		\return Returns the system call count.
+	*/
+	unsigned long vmc96_uring_get_enter_count( VMC96_uring_t * ring );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/* eof */